@@ -10,6 +10,7 @@
 #include <zephyr/drivers/spi.h>
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
 #include "mx_flash.h"
 
 LOG_MODULE_REGISTER(mx_flash, CONFIG_FLASH_LOG_LEVEL);
@@ -17,13 +18,39 @@ LOG_MODULE_REGISTER(mx_flash, CONFIG_FLASH_LOG_LEVEL);
 /* Maximum timeout for flash operations (in ms) */
 #define MX_FLASH_TIMEOUT_MS 1000
 
+/* Erase timeout when SFDP gives no timing (in ms) */
+#define MX_FLASH_ERASE_TIMEOUT_MS 4000
+
+static const struct flash_parameters mx_flash_parameters = {
+    .write_block_size = 1,
+    .erase_value = 0xff,
+};
+
 /* Internal functions */
-static int mx_flash_wait_ready(const struct device *dev)
+static void mx_flash_lock(struct mx_flash_data *flash_data)
+{
+    k_sem_take(&flash_data->lock, K_FOREVER);
+    flash_data->lock_start = k_cycle_get_32();
+}
+
+/* Release the lock, tracking the longest hold in max_cycles if given */
+static void mx_flash_unlock(struct mx_flash_data *flash_data, uint32_t *max_cycles)
+{
+    uint32_t held = k_cycle_get_32() - flash_data->lock_start;
+
+    if (max_cycles && held > *max_cycles) {
+        *max_cycles = held;
+    }
+
+    k_sem_give(&flash_data->lock);
+}
+
+static int mx_flash_wait_ready(const struct device *dev, uint32_t timeout_ms)
 {
     const struct mx_flash_config *config = dev->config;
     uint8_t cmd = MX25_CMD_READ_STATUS;
     uint8_t status;
-    int64_t timeout = k_uptime_get() + MX_FLASH_TIMEOUT_MS;
+    int64_t timeout = k_uptime_get() + timeout_ms;
 
     struct spi_buf tx_buf = {
         .buf = &cmd,
@@ -34,13 +61,19 @@ static int mx_flash_wait_ready(const struct device *dev)
         .count = 1
     };
 
-    struct spi_buf rx_buf = {
-        .buf = &status,
-        .len = 1
+    struct spi_buf rx_buf[] = {
+        {
+            .buf = NULL,
+            .len = 1
+        },
+        {
+            .buf = &status,
+            .len = 1
+        }
     };
     const struct spi_buf_set rx = {
-        .buffers = &rx_buf,
-        .count = 1
+        .buffers = rx_buf,
+        .count = 2
     };
 
     do {
@@ -59,6 +92,27 @@ static int mx_flash_wait_ready(const struct device *dev)
     return -ETIMEDOUT;
 }
 
+/*
+ * Take the lock for a chip access. A write leaves the chip programming
+ * with the lock released, so the next user waits for WIP to clear.
+ */
+static int mx_flash_lock_ready(const struct device *dev)
+{
+    struct mx_flash_data *flash_data = dev->data;
+    int ret = 0;
+
+    mx_flash_lock(flash_data);
+
+    if (flash_data->program_pending) {
+        ret = mx_flash_wait_ready(dev, MX_FLASH_TIMEOUT_MS);
+        if (ret == 0) {
+            flash_data->program_pending = false;
+        }
+    }
+
+    return ret;
+}
+
 static int mx_flash_write_enable(const struct device *dev)
 {
     const struct mx_flash_config *config = dev->config;
@@ -89,23 +143,223 @@ static int mx_flash_read_id(const struct device *dev, uint8_t *id)
         .count = 1
     };
 
-    struct spi_buf rx_buf = {
-        .buf = id,
-        .len = 3
+    struct spi_buf rx_buf[] = {
+        {
+            .buf = NULL,
+            .len = 1
+        },
+        {
+            .buf = id,
+            .len = 3
+        }
     };
     const struct spi_buf_set rx = {
-        .buffers = &rx_buf,
+        .buffers = rx_buf,
+        .count = 2
+    };
+
+    return spi_transceive_dt(&config->spi, &tx, &rx);
+}
+
+static int mx_flash_read_sfdp(const struct device *dev, uint32_t addr,
+                              void *buf, size_t len)
+{
+    const struct mx_flash_config *config = dev->config;
+    uint8_t cmd[5] = {MX25_CMD_READ_SFDP,
+                      (addr >> 16) & 0xFF,
+                      (addr >> 8) & 0xFF,
+                      addr & 0xFF,
+                      0x00}; /* Dummy byte */
+
+    struct spi_buf tx_buf = {
+        .buf = cmd,
+        .len = sizeof(cmd)
+    };
+    const struct spi_buf_set tx = {
+        .buffers = &tx_buf,
         .count = 1
     };
 
+    struct spi_buf rx_buf[] = {
+        {
+            .buf = NULL,
+            .len = sizeof(cmd)
+        },
+        {
+            .buf = buf,
+            .len = len
+        }
+    };
+    const struct spi_buf_set rx = {
+        .buffers = rx_buf,
+        .count = 2
+    };
+
     return spi_transceive_dt(&config->spi, &tx, &rx);
 }
 
-/* API Implementation */
-int mx_flash_read(const struct device *dev, off_t offset, void *data, size_t len)
+/* Decode a JESD216 erase time field: count in the low 5 bits, units above */
+static uint32_t mx_flash_sfdp_erase_ms(uint32_t field)
+{
+    static const uint16_t unit_ms[] = {1, 16, 128, 1000};
+
+    return ((field & 0x1F) + 1) * unit_ms[(field >> 5) & 0x03];
+}
+
+/* Parse the Basic Flash Parameter Table into the runtime geometry */
+static int mx_flash_sfdp_probe(const struct device *dev)
+{
+    struct mx_flash_data *data = dev->data;
+    uint8_t hdr[MX25_SFDP_HEADER_SIZE];
+    uint8_t raw[MX25_SFDP_BFPT_MAX_DWORDS * 4];
+    uint32_t bfpt[MX25_SFDP_BFPT_MAX_DWORDS] = {0};
+    int ret;
+
+    ret = mx_flash_read_sfdp(dev, 0, hdr, sizeof(hdr));
+    if (ret < 0) {
+        return ret;
+    }
+
+    if (sys_get_le32(&hdr[0]) != MX25_SFDP_SIGNATURE) {
+        return -ENOTSUP;
+    }
+
+    /* The first parameter header always describes the BFPT */
+    const uint8_t *ph = &hdr[8];
+    if (ph[0] != MX25_SFDP_BFPT_ID_LSB || ph[7] != MX25_SFDP_BFPT_ID_MSB) {
+        return -ENOTSUP;
+    }
+
+    size_t dwords = MIN(ph[3], MX25_SFDP_BFPT_MAX_DWORDS);
+    if (dwords < 9) {
+        return -ENOTSUP;
+    }
+
+    ret = mx_flash_read_sfdp(dev, sys_get_le24(&ph[4]), raw, dwords * 4);
+    if (ret < 0) {
+        return ret;
+    }
+
+    for (size_t i = 0; i < dwords; i++) {
+        bfpt[i] = sys_get_le32(&raw[i * 4]);
+    }
+
+    /* DWORD 2: density in bits */
+    if (bfpt[1] & BIT(31)) {
+        uint32_t n = bfpt[1] & 0x7FFFFFFF;
+        if (n < 3 || n > 34) {
+            return -ENOTSUP;
+        }
+        data->size = BIT(n - 3);
+    } else {
+        data->size = (bfpt[1] + 1) / 8;
+    }
+
+    /* DWORDs 8-9: erase types as (size exponent, opcode) pairs */
+    memset(data->erase_types, 0, sizeof(data->erase_types));
+    for (int i = 0; i < MX25_ERASE_TYPES; i++) {
+        uint16_t et = bfpt[7 + i / 2] >> (16 * (i % 2));
+        uint8_t exp = et & 0xFF;
+
+        if (exp > 0 && exp < 32) {
+            data->erase_types[i].size = BIT(exp);
+            data->erase_types[i].opcode = et >> 8;
+        }
+    }
+
+    /* DWORD 1: 4 KB erase opcode, for tables without erase types */
+    if (data->erase_types[0].size == 0 && (bfpt[0] & 0x03) == 0x01) {
+        data->erase_types[0].size = MX25_SECTOR_SIZE;
+        data->erase_types[0].opcode = (bfpt[0] >> 8) & 0xFF;
+    }
+
+    if (data->erase_types[0].size == 0 && data->erase_types[1].size == 0 &&
+        data->erase_types[2].size == 0 && data->erase_types[3].size == 0) {
+        return -ENOTSUP;
+    }
+
+    /* DWORDs 10-11 (JESD216A): erase and program timings, page size */
+    if (dwords >= 11) {
+        uint32_t mult = 2 * ((bfpt[9] & 0x0F) + 1);
+
+        for (int i = 0; i < MX25_ERASE_TYPES; i++) {
+            if (data->erase_types[i].size) {
+                uint32_t field = (bfpt[9] >> (4 + 7 * i)) & 0x7F;
+                data->erase_types[i].typ_ms = mx_flash_sfdp_erase_ms(field);
+                data->erase_types[i].max_ms = data->erase_types[i].typ_ms * mult;
+            }
+        }
+
+        data->page_size = BIT((bfpt[10] >> 4) & 0x0F);
+        data->program_typ_us = (((bfpt[10] >> 8) & 0x1F) + 1) *
+                               ((bfpt[10] & BIT(13)) ? 64 : 8);
+    }
+
+    return 0;
+}
+
+/* Fill the geometry from devicetree, sorted by the SFDP probe if it succeeds */
+static void mx_flash_setup_geometry(const struct device *dev)
+{
+    const struct mx_flash_config *config = dev->config;
+    struct mx_flash_data *data = dev->data;
+    int ret = -ENOTSUP;
+
+    data->size = config->size;
+    data->page_size = config->page_size;
+    data->program_typ_us = 0;
+
+    if (IS_ENABLED(CONFIG_MX25_FLASH_SFDP)) {
+        ret = mx_flash_sfdp_probe(dev);
+    }
+
+    if (ret < 0) {
+        LOG_WRN("SFDP unavailable (%d), using devicetree geometry", ret);
+        data->size = config->size;
+        data->page_size = config->page_size;
+        memset(data->erase_types, 0, sizeof(data->erase_types));
+        data->erase_types[0].size = config->sector_size;
+        data->erase_types[0].opcode = MX25_CMD_SECTOR_ERASE;
+        data->erase_types[1].size = config->block_size;
+        data->erase_types[1].opcode = MX25_CMD_BLOCK_ERASE_64K;
+    } else if (data->size != config->size) {
+        LOG_WRN("SFDP size %u differs from devicetree size %u",
+                data->size, config->size);
+    }
+
+    /* Sort erase types by ascending size, unused entries last */
+    for (int i = 0; i < MX25_ERASE_TYPES - 1; i++) {
+        for (int j = 0; j < MX25_ERASE_TYPES - 1 - i; j++) {
+            struct mx_flash_erase_type *a = &data->erase_types[j];
+            struct mx_flash_erase_type *b = &data->erase_types[j + 1];
+
+            if ((a->size == 0 && b->size != 0) ||
+                (b->size != 0 && b->size < a->size)) {
+                struct mx_flash_erase_type tmp = *a;
+                *a = *b;
+                *b = tmp;
+            }
+        }
+    }
+
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+    data->layout.pages_size = data->erase_types[0].size;
+    data->layout.pages_count = data->size / data->erase_types[0].size;
+#endif
+
+    for (int i = 0; i < MX25_ERASE_TYPES && data->erase_types[i].size; i++) {
+        LOG_INF("Erase type %d: %u bytes, opcode 0x%02x, typ %u ms", i,
+                data->erase_types[i].size, data->erase_types[i].opcode,
+                data->erase_types[i].typ_ms);
+    }
+    LOG_INF("Size %u bytes, page %u bytes, program typ %u us",
+            data->size, data->page_size, data->program_typ_us);
+}
+
+/* Read without taking the lock, the command phase is clocked into a dummy buffer */
+static int mx_flash_spi_read(const struct device *dev, off_t offset, void *data, size_t len)
 {
     const struct mx_flash_config *config = dev->config;
-    struct mx_flash_data *flash_data = dev->data;
     uint8_t cmd[4] = {MX25_CMD_READ_DATA,
                       (offset >> 16) & 0xFF,
                       (offset >> 8) & 0xFF,
@@ -123,6 +377,10 @@ int mx_flash_read(const struct device *dev, off_t offset, void *data, size_t len
     };
 
     struct spi_buf rx_buf[] = {
+        {
+            .buf = NULL,
+            .len = sizeof(cmd)
+        },
         {
             .buf = data,
             .len = len
@@ -130,66 +388,296 @@ int mx_flash_read(const struct device *dev, off_t offset, void *data, size_t len
     };
     const struct spi_buf_set rx = {
         .buffers = rx_buf,
-        .count = 1
+        .count = 2
     };
 
-    k_sem_take(&flash_data->lock, K_FOREVER);
-    int ret = spi_transceive_dt(&config->spi, &tx, &rx);
-    k_sem_give(&flash_data->lock);
+    return spi_transceive_dt(&config->spi, &tx, &rx);
+}
 
-    return ret;
+#if defined(CONFIG_MX25_FLASH_READ_CACHE)
+/* Drop cached pages overlapping a programmed or erased range, lock held */
+static void mx_flash_cache_invalidate(struct mx_flash_data *flash_data,
+                                      off_t offset, size_t len)
+{
+    for (int i = 0; i < CONFIG_MX25_FLASH_READ_CACHE_PAGES; i++) {
+        struct mx_flash_cache_entry *entry = &flash_data->cache[i];
+
+        if (entry->valid && entry->addr < offset + len &&
+            entry->addr + MX25_PAGE_SIZE > offset) {
+            entry->valid = false;
+            flash_data->cache_stats.invalidations++;
+        }
+    }
 }
 
-int mx_flash_write(const struct device *dev, off_t offset, const void *data, size_t len)
+/* Serve a read page by page from the LRU cache, filling misses, lock held */
+static int mx_flash_cache_read(const struct device *dev, off_t offset,
+                               void *data, size_t len)
 {
-    const struct mx_flash_config *config = dev->config;
     struct mx_flash_data *flash_data = dev->data;
-    int ret;
+    uint8_t *dst = data;
 
-    if (flash_data->write_protection) {
-        return -EACCES;
+    while (len > 0) {
+        uint32_t page = offset & ~(MX25_PAGE_SIZE - 1);
+        size_t page_offset = offset - page;
+        size_t copy_len = MIN(len, MX25_PAGE_SIZE - page_offset);
+        struct mx_flash_cache_entry *entry = NULL;
+        struct mx_flash_cache_entry *victim = &flash_data->cache[0];
+
+        for (int i = 0; i < CONFIG_MX25_FLASH_READ_CACHE_PAGES; i++) {
+            struct mx_flash_cache_entry *e = &flash_data->cache[i];
+
+            if (e->valid && e->addr == page) {
+                entry = e;
+                break;
+            }
+
+            /* Prefer a free entry, otherwise the least recently used */
+            if (victim->valid && (!e->valid || e->age < victim->age)) {
+                victim = e;
+            }
+        }
+
+        if (entry) {
+            flash_data->cache_stats.hits++;
+        } else {
+            int ret = mx_flash_spi_read(dev, page, victim->data, MX25_PAGE_SIZE);
+            if (ret < 0) {
+                victim->valid = false;
+                return ret;
+            }
+
+            victim->addr = page;
+            victim->valid = true;
+            entry = victim;
+            flash_data->cache_stats.misses++;
+        }
+
+        entry->age = ++flash_data->cache_clock;
+        memcpy(dst, &entry->data[page_offset], copy_len);
+
+        offset += copy_len;
+        dst += copy_len;
+        len -= copy_len;
     }
 
-    k_sem_take(&flash_data->lock, K_FOREVER);
+    return 0;
+}
+
+int mx_flash_cache_stats_get(const struct device *dev, struct mx_flash_cache_stats *stats)
+{
+    struct mx_flash_data *flash_data = dev->data;
+
+    if (!stats) {
+        return -EINVAL;
+    }
+
+    mx_flash_lock(flash_data);
+    *stats = flash_data->cache_stats;
+    mx_flash_unlock(flash_data, NULL);
+
+    return 0;
+}
 
-    /* Write page by page */
+void mx_flash_cache_stats_reset(const struct device *dev)
+{
+    struct mx_flash_data *flash_data = dev->data;
+
+    mx_flash_lock(flash_data);
+    memset(&flash_data->cache_stats, 0, sizeof(flash_data->cache_stats));
+    mx_flash_unlock(flash_data, NULL);
+}
+#else
+#define mx_flash_cache_invalidate(flash_data, offset, len)
+#endif /* CONFIG_MX25_FLASH_READ_CACHE */
+
+/* API Implementation */
+int mx_flash_read_hint(const struct device *dev, off_t offset, void *data, size_t len,
+                       enum mx_flash_read_hint hint)
+{
+    struct mx_flash_data *flash_data = dev->data;
+    uint8_t *dst = data;
+    __unused bool cached = len <= MX25_PAGE_SIZE;
+    int ret = 0;
+
+    /*
+     * Split reads into bounded chunks and release the lock in between,
+     * so a large backfill read cannot block other flash users for its
+     * whole duration. Small reads take a single chunk.
+     */
     while (len > 0) {
-        size_t page_offset = offset & (config->page_size - 1);
-        size_t write_len = MIN(len, config->page_size - page_offset);
-
-        uint8_t cmd[4] = {MX25_CMD_PAGE_PROGRAM,
-                         (offset >> 16) & 0xFF,
-                         (offset >> 8) & 0xFF,
-                         offset & 0xFF};
-
-        struct spi_buf tx_buf[] = {
-            {
-                .buf = cmd,
-                .len = sizeof(cmd)
-            },
-            {
-                .buf = (void *)data,
-                .len = write_len
+        size_t chunk = MIN(len, CONFIG_MX25_FLASH_READ_CHUNK_SIZE);
+
+        if (hint == MX_FLASH_READ_INTERACTIVE) {
+            atomic_inc(&flash_data->interactive_waiters);
+            ret = mx_flash_lock_ready(dev);
+            atomic_dec(&flash_data->interactive_waiters);
+        } else {
+            ret = mx_flash_lock_ready(dev);
+        }
+
+        if (ret == 0) {
+#if defined(CONFIG_MX25_FLASH_READ_CACHE)
+            /* Small reads are metadata, bulk reads bypass the cache */
+            if (cached) {
+                ret = mx_flash_cache_read(dev, offset, dst, chunk);
+            } else {
+                ret = mx_flash_spi_read(dev, offset, dst, chunk);
             }
-        };
-        const struct spi_buf_set tx = {
-            .buffers = tx_buf,
-            .count = 2
-        };
+#else
+            ret = mx_flash_spi_read(dev, offset, dst, chunk);
+#endif
+        }
+
+        flash_data->read_chunks++;
+        mx_flash_unlock(flash_data, &flash_data->read_max_cycles);
 
-        ret = mx_flash_write_enable(dev);
         if (ret < 0) {
             break;
         }
 
-        ret = spi_write_dt(&config->spi, &tx);
-        if (ret < 0) {
-            break;
+        offset += chunk;
+        dst += chunk;
+        len -= chunk;
+
+        /*
+         * Background reads stay off the lock until the queued interactive
+         * reads have taken it. Sleeping lets them run even when they
+         * have a lower priority than the background thread.
+         */
+        if (hint == MX_FLASH_READ_BACKGROUND && len > 0 &&
+            atomic_get(&flash_data->interactive_waiters) > 0) {
+            atomic_inc(&flash_data->read_yields);
+            do {
+                k_sleep(K_TICKS(1));
+            } while (atomic_get(&flash_data->interactive_waiters) > 0);
+        }
+    }
+
+    return ret;
+}
+
+int mx_flash_read(const struct device *dev, off_t offset, void *data, size_t len)
+{
+    const struct mx_flash_data *flash_data = dev->data;
+    enum mx_flash_read_hint hint = MX_FLASH_READ_INTERACTIVE;
+
+    /* The flash API carries no hint, bulk readers mark their thread */
+    if (flash_data->background_thread == k_current_get()) {
+        hint = MX_FLASH_READ_BACKGROUND;
+    }
+
+    return mx_flash_read_hint(dev, offset, data, len, hint);
+}
+
+void mx_flash_read_background_set(const struct device *dev, bool enable)
+{
+    struct mx_flash_data *flash_data = dev->data;
+
+    if (enable) {
+        flash_data->background_thread = k_current_get();
+    } else if (flash_data->background_thread == k_current_get()) {
+        flash_data->background_thread = NULL;
+    }
+}
+
+int mx_flash_lock_stats_get(const struct device *dev, struct mx_flash_lock_stats *stats)
+{
+    struct mx_flash_data *flash_data = dev->data;
+
+    if (!stats) {
+        return -EINVAL;
+    }
+
+    mx_flash_lock(flash_data);
+    stats->max_read_hold_us = k_cyc_to_us_ceil32(flash_data->read_max_cycles);
+    stats->max_write_hold_us = k_cyc_to_us_ceil32(flash_data->write_max_cycles);
+    stats->max_erase_hold_us = k_cyc_to_us_ceil32(flash_data->erase_max_cycles);
+    stats->read_chunks = flash_data->read_chunks;
+    stats->read_yields = atomic_get(&flash_data->read_yields);
+    mx_flash_unlock(flash_data, NULL);
+
+    return 0;
+}
+
+void mx_flash_lock_stats_reset(const struct device *dev)
+{
+    struct mx_flash_data *flash_data = dev->data;
+
+    mx_flash_lock(flash_data);
+    flash_data->read_max_cycles = 0;
+    flash_data->write_max_cycles = 0;
+    flash_data->erase_max_cycles = 0;
+    flash_data->read_chunks = 0;
+    atomic_clear(&flash_data->read_yields);
+    mx_flash_unlock(flash_data, NULL);
+}
+
+/* Issue write enable and program one page, without waiting for completion */
+static int mx_flash_program_page(const struct device *dev, off_t offset,
+                                 const void *data, size_t len)
+{
+    const struct mx_flash_config *config = dev->config;
+    uint8_t cmd[4] = {MX25_CMD_PAGE_PROGRAM,
+                      (offset >> 16) & 0xFF,
+                      (offset >> 8) & 0xFF,
+                      offset & 0xFF};
+
+    struct spi_buf tx_buf[] = {
+        {
+            .buf = cmd,
+            .len = sizeof(cmd)
+        },
+        {
+            .buf = (void *)data,
+            .len = len
+        }
+    };
+    const struct spi_buf_set tx = {
+        .buffers = tx_buf,
+        .count = 2
+    };
+
+    int ret = mx_flash_write_enable(dev);
+    if (ret < 0) {
+        return ret;
+    }
+
+    return spi_write_dt(&config->spi, &tx);
+}
+
+int mx_flash_write(const struct device *dev, off_t offset, const void *data, size_t len)
+{
+    struct mx_flash_data *flash_data = dev->data;
+    int ret = 0;
+
+    if (flash_data->write_protection) {
+        return -EACCES;
+    }
+
+    /*
+     * Write page by page, holding the lock only to issue each program.
+     * The chip programs with the lock released and the next access,
+     * ours or another user's, waits for WIP in mx_flash_lock_ready().
+     */
+    while (len > 0) {
+        size_t page_offset = offset & (flash_data->page_size - 1);
+        size_t write_len = MIN(len, flash_data->page_size - page_offset);
+
+        ret = mx_flash_lock_ready(dev);
+        if (ret == 0) {
+            mx_flash_cache_invalidate(flash_data, offset, write_len);
+            ret = mx_flash_program_page(dev, offset, data, write_len);
+            flash_data->program_pending = (ret == 0);
         }
+        mx_flash_unlock(flash_data, &flash_data->write_max_cycles);
 
-        ret = mx_flash_wait_ready(dev);
         if (ret < 0) {
-            break;
+            return ret;
+        }
+
+        if (flash_data->program_typ_us) {
+            k_sleep(K_USEC(flash_data->program_typ_us));
         }
 
         offset += write_len;
@@ -197,54 +685,110 @@ int mx_flash_write(const struct device *dev, off_t offset, const void *data, siz
         len -= write_len;
     }
 
-    k_sem_give(&flash_data->lock);
+    /* Return once the last page is programmed */
+    ret = mx_flash_lock_ready(dev);
+    mx_flash_unlock(flash_data, &flash_data->write_max_cycles);
     return ret;
 }
 
-int mx_flash_erase(const struct device *dev, off_t offset)
+int mx_flash_erase(const struct device *dev, off_t offset, size_t size)
 {
     const struct mx_flash_config *config = dev->config;
     struct mx_flash_data *flash_data = dev->data;
-    int ret;
+    uint32_t min_size = flash_data->erase_types[0].size;
+    int ret = 0;
 
     if (flash_data->write_protection) {
         return -EACCES;
     }
 
-    k_sem_take(&flash_data->lock, K_FOREVER);
+    if ((offset % min_size) != 0 || (size % min_size) != 0 ||
+        offset < 0 || (offset + size) > flash_data->size) {
+        return -EINVAL;
+    }
 
-    uint8_t cmd[4] = {MX25_CMD_SECTOR_ERASE,
-                      (offset >> 16) & 0xFF,
-                      (offset >> 8) & 0xFF,
-                      offset & 0xFF};
+    ret = mx_flash_lock_ready(dev);
+    if (ret < 0) {
+        mx_flash_unlock(flash_data, &flash_data->erase_max_cycles);
+        return ret;
+    }
 
-    struct spi_buf tx_buf = {
-        .buf = cmd,
-        .len = sizeof(cmd)
-    };
-    const struct spi_buf_set tx = {
-        .buffers = &tx_buf,
-        .count = 1
-    };
+    mx_flash_cache_invalidate(flash_data, offset, size);
+
+    while (size > 0) {
+        const struct mx_flash_erase_type *et = &flash_data->erase_types[0];
+
+        /* Use the largest erase unit that is aligned and fits */
+        for (int i = MX25_ERASE_TYPES - 1; i > 0; i--) {
+            const struct mx_flash_erase_type *t = &flash_data->erase_types[i];
+
+            if (t->size && (offset % t->size) == 0 && size >= t->size) {
+                et = t;
+                break;
+            }
+        }
+
+        uint8_t cmd[4] = {et->opcode,
+                          (offset >> 16) & 0xFF,
+                          (offset >> 8) & 0xFF,
+                          offset & 0xFF};
+
+        struct spi_buf tx_buf = {
+            .buf = cmd,
+            .len = sizeof(cmd)
+        };
+        const struct spi_buf_set tx = {
+            .buffers = &tx_buf,
+            .count = 1
+        };
+
+        ret = mx_flash_write_enable(dev);
+        if (ret < 0) {
+            break;
+        }
 
-    ret = mx_flash_write_enable(dev);
-    if (ret == 0) {
         ret = spi_write_dt(&config->spi, &tx);
-        if (ret == 0) {
-            ret = mx_flash_wait_ready(dev);
+        if (ret < 0) {
+            break;
+        }
+
+        ret = mx_flash_wait_ready(dev, et->max_ms ? et->max_ms : MX_FLASH_ERASE_TIMEOUT_MS);
+        if (ret < 0) {
+            break;
         }
+
+        offset += et->size;
+        size -= et->size;
     }
 
-    k_sem_give(&flash_data->lock);
+    mx_flash_unlock(flash_data, &flash_data->erase_max_cycles);
     return ret;
 }
 
 size_t mx_flash_size(const struct device *dev)
 {
-    const struct mx_flash_config *config = dev->config;
-    return config->size;
+    const struct mx_flash_data *data = dev->data;
+    return data->size;
 }
 
+const struct flash_parameters *mx_flash_get_parameters(const struct device *dev)
+{
+    ARG_UNUSED(dev);
+    return &mx_flash_parameters;
+}
+
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+void mx_flash_page_layout(const struct device *dev,
+                          const struct flash_pages_layout **layout,
+                          size_t *layout_size)
+{
+    const struct mx_flash_data *data = dev->data;
+
+    *layout = &data->layout;
+    *layout_size = 1;
+}
+#endif
+
 int mx_flash_write_protection_set(const struct device *dev, bool enable)
 {
     struct mx_flash_data *data = dev->data;
@@ -304,6 +848,10 @@ static int mx_flash_init(const struct device *dev)
 
     k_sem_init(&data->lock, 1, 1);
     data->write_protection = false;
+    atomic_clear(&data->interactive_waiters);
+    atomic_clear(&data->read_yields);
+    data->background_thread = NULL;
+    data->program_pending = false;
 
     /* Configure GPIOs if available */
     if (config->reset_gpio.port) {
@@ -335,6 +883,9 @@ static int mx_flash_init(const struct device *dev)
     }
 
     LOG_INF("MX25 Flash ID: %02x %02x %02x", id[0], id[1], id[2]);
+
+    /* Discover geometry and erase opcodes */
+    mx_flash_setup_geometry(dev);
     return 0;
 }
 
@@ -343,7 +894,10 @@ static const struct flash_driver_api mx_flash_api = {
     .read = mx_flash_read,
     .write = mx_flash_write,
     .erase = mx_flash_erase,
-    .get_size = mx_flash_size,
+    .get_parameters = mx_flash_get_parameters,
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+    .page_layout = mx_flash_page_layout,
+#endif
 };
 
 /* Device instantiation */
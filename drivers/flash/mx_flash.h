@@ -9,6 +9,8 @@
 #include <zephyr/kernel.h>
 #include <zephyr/drivers/flash.h>
 #include <zephyr/drivers/spi.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/sys/atomic.h>
 
 /* MX25 Commands */
 #define MX25_CMD_WRITE_ENABLE      0x06
@@ -25,6 +27,7 @@
 #define MX25_CMD_POWER_DOWN        0xB9
 #define MX25_CMD_RELEASE_POWER_DOWN 0xAB
 #define MX25_CMD_READ_ID           0x9F
+#define MX25_CMD_READ_SFDP         0x5A
 
 /* Status Register bits */
 #define MX25_STATUS_WIP_BIT        0  /* Write in progress */
@@ -42,6 +45,22 @@
 #define MX25_BLOCK_SIZE_32K       32768
 #define MX25_BLOCK_SIZE_64K       65536
 
+/* SFDP (JESD216) definitions */
+#define MX25_SFDP_SIGNATURE       0x50444653  /* "SFDP", little endian */
+#define MX25_SFDP_HEADER_SIZE     16          /* SFDP header + BFPT parameter header */
+#define MX25_SFDP_BFPT_ID_LSB     0x00
+#define MX25_SFDP_BFPT_ID_MSB     0xFF
+#define MX25_SFDP_BFPT_MAX_DWORDS 16
+#define MX25_ERASE_TYPES          4
+
+/* Erase type discovered from SFDP or devicetree */
+struct mx_flash_erase_type {
+    uint32_t size;        /* Erase unit size in bytes, 0 if unused */
+    uint32_t typ_ms;      /* Typical erase time in ms, 0 if unknown */
+    uint32_t max_ms;      /* Maximum erase time in ms, 0 if unknown */
+    uint8_t opcode;       /* Erase command */
+};
+
 /* Configuration structure */
 struct mx_flash_config {
     struct spi_dt_spec spi;
@@ -54,36 +73,133 @@ struct mx_flash_config {
     uint32_t page_size;
 };
 
+/* Read cache entry, one flash page */
+struct mx_flash_cache_entry {
+    uint32_t addr;        /* Page aligned flash address */
+    uint32_t age;         /* LRU stamp, higher is more recent */
+    bool valid;
+    uint8_t data[MX25_PAGE_SIZE];
+};
+
+/* Read cache statistics */
+struct mx_flash_cache_stats {
+    uint32_t hits;
+    uint32_t misses;
+    uint32_t invalidations;
+};
+
+/* Read scheduling hint */
+enum mx_flash_read_hint {
+    MX_FLASH_READ_INTERACTIVE,  /* Latency sensitive, e.g. file system metadata */
+    MX_FLASH_READ_BACKGROUND,   /* Bulk transfer, yields to interactive reads */
+};
+
+/* Lock contention statistics */
+struct mx_flash_lock_stats {
+    uint32_t max_read_hold_us;  /* Longest lock hold by a read chunk */
+    uint32_t max_write_hold_us; /* Longest lock hold to program a page */
+    uint32_t max_erase_hold_us; /* Longest lock hold by an erase */
+    uint32_t read_chunks;       /* Read chunks issued */
+    uint32_t read_yields;       /* Background reads standing back for interactive ones */
+};
+
 /* Runtime data structure */
 struct mx_flash_data {
     struct k_sem lock;
+    uint32_t lock_start;
+    uint32_t read_max_cycles;
+    uint32_t write_max_cycles;
+    uint32_t erase_max_cycles;
+    uint32_t read_chunks;
+    atomic_t read_yields;
+    atomic_t interactive_waiters;
+    k_tid_t background_thread;
+    bool program_pending;
     uint8_t *write_buf;
     size_t write_buf_size;
     bool write_protection;
+
+    /* Geometry, from SFDP when available, devicetree otherwise */
+    uint32_t size;
+    uint32_t page_size;
+    uint32_t program_typ_us;
+    struct mx_flash_erase_type erase_types[MX25_ERASE_TYPES]; /* Ascending size */
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+    struct flash_pages_layout layout;
+#endif
+
+#if defined(CONFIG_MX25_FLASH_READ_CACHE)
+    struct mx_flash_cache_entry cache[CONFIG_MX25_FLASH_READ_CACHE_PAGES];
+    uint32_t cache_clock;
+    struct mx_flash_cache_stats cache_stats;
+#endif
 };
 
 /**
- * @brief Initialize MX flash device
+ * @brief Read data from flash
  *
  * @param dev Pointer to device structure
+ * @param offset Offset to read from
+ * @param data Buffer to store read data
+ * @param len Number of bytes to read
  * @return 0 on success, negative errno code on failure
  */
-int mx_flash_init(const struct device *dev);
+int mx_flash_read(const struct device *dev, off_t offset, void *data, size_t len);
 
 /**
- * @brief Read data from flash
+ * @brief Read data from flash with a scheduling hint
+ *
+ * Reads are split into CONFIG_MX25_FLASH_READ_CHUNK_SIZE chunks and the
+ * device lock is released between chunks. Background reads also sleep
+ * between chunks until interactive reads waiting for the lock have
+ * taken it.
  *
  * @param dev Pointer to device structure
  * @param offset Offset to read from
  * @param data Buffer to store read data
  * @param len Number of bytes to read
+ * @param hint Scheduling hint
  * @return 0 on success, negative errno code on failure
  */
-int mx_flash_read(const struct device *dev, off_t offset, void *data, size_t len);
+int mx_flash_read_hint(const struct device *dev, off_t offset, void *data, size_t len,
+                       enum mx_flash_read_hint hint);
+
+/**
+ * @brief Mark reads of the calling thread as background
+ *
+ * Reads through the flash API, e.g. from LittleFS, carry no hint. A
+ * thread doing a bulk transfer marks itself for its duration and its
+ * mx_flash_read() calls then run as MX_FLASH_READ_BACKGROUND. One
+ * thread per device can be marked at a time.
+ *
+ * @param dev Pointer to device structure
+ * @param enable true to mark the calling thread, false to clear the mark
+ */
+void mx_flash_read_background_set(const struct device *dev, bool enable);
+
+/**
+ * @brief Get lock contention statistics
+ *
+ * @param dev Pointer to device structure
+ * @param stats Pointer to store statistics
+ * @return 0 on success, negative errno code on failure
+ */
+int mx_flash_lock_stats_get(const struct device *dev, struct mx_flash_lock_stats *stats);
+
+/**
+ * @brief Reset lock contention statistics
+ *
+ * @param dev Pointer to device structure
+ */
+void mx_flash_lock_stats_reset(const struct device *dev);
 
 /**
  * @brief Write data to flash
  *
+ * The device lock is released while each page programs, so other
+ * flash users wait for at most one page program instead of the whole
+ * write. The call returns once the last page is programmed.
+ *
  * @param dev Pointer to device structure
  * @param offset Offset to write to
  * @param data Data to write
@@ -93,13 +209,17 @@ int mx_flash_read(const struct device *dev, off_t offset, void *data, size_t len
 int mx_flash_write(const struct device *dev, off_t offset, const void *data, size_t len);
 
 /**
- * @brief Erase flash sector
+ * @brief Erase flash region
+ *
+ * The region is split into the largest erase units that fit its
+ * alignment, so multi-sector erases use block erase commands.
  *
  * @param dev Pointer to device structure
- * @param offset Offset of sector to erase
+ * @param offset Offset of region to erase, aligned to the smallest erase unit
+ * @param size Size of region, multiple of the smallest erase unit
  * @return 0 on success, negative errno code on failure
  */
-int mx_flash_erase(const struct device *dev, off_t offset);
+int mx_flash_erase(const struct device *dev, off_t offset, size_t size);
 
 /**
  * @brief Get flash device size
@@ -109,6 +229,49 @@ int mx_flash_erase(const struct device *dev, off_t offset);
  */
 size_t mx_flash_size(const struct device *dev);
 
+/**
+ * @brief Get flash parameters
+ *
+ * @param dev Pointer to device structure
+ * @return Pointer to flash parameters
+ */
+const struct flash_parameters *mx_flash_get_parameters(const struct device *dev);
+
+#if defined(CONFIG_FLASH_PAGE_LAYOUT)
+/**
+ * @brief Get flash page layout
+ *
+ * Pages are the smallest erase unit of the fitted chip.
+ *
+ * @param dev Pointer to device structure
+ * @param layout Pointer to store layout table
+ * @param layout_size Pointer to store number of layout entries
+ */
+void mx_flash_page_layout(const struct device *dev,
+                          const struct flash_pages_layout **layout,
+                          size_t *layout_size);
+#endif
+
+#if defined(CONFIG_MX25_FLASH_READ_CACHE)
+/**
+ * @brief Get read cache statistics
+ *
+ * Hit rate is hits / (hits + misses).
+ *
+ * @param dev Pointer to device structure
+ * @param stats Pointer to store statistics
+ * @return 0 on success, negative errno code on failure
+ */
+int mx_flash_cache_stats_get(const struct device *dev, struct mx_flash_cache_stats *stats);
+
+/**
+ * @brief Reset read cache statistics
+ *
+ * @param dev Pointer to device structure
+ */
+void mx_flash_cache_stats_reset(const struct device *dev);
+#endif
+
 /**
  * @brief Enable or disable write protection
  *
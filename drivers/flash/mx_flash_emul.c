@@ -0,0 +1,435 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#define DT_DRV_COMPAT macronix_mx25
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/spi.h>
+#include <zephyr/drivers/spi_emul.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/logging/log.h>
+#include "mx_flash.h"
+#include "mx_flash_emul.h"
+
+LOG_MODULE_REGISTER(mx_flash_emul, CONFIG_FLASH_LOG_LEVEL);
+
+/* SFDP layout: header, one parameter header, BFPT at 0x30 */
+#define MX_FLASH_EMUL_SFDP_SIZE    0x70
+#define MX_FLASH_EMUL_BFPT_ADDR    0x30
+#define MX_FLASH_EMUL_BFPT_DWORDS  16
+
+/* Configuration structure */
+struct mx_flash_emul_config {
+    uint8_t *mem;
+    uint32_t size;
+};
+
+/* Runtime data structure */
+struct mx_flash_emul_data {
+    uint8_t sfdp[MX_FLASH_EMUL_SFDP_SIZE];
+    uint8_t status;
+    bool power_down;
+    bool timing;
+    uint64_t busy_until_us;
+    struct mx_flash_emul_stats stats;
+};
+
+/* Byte cursor over a SPI buffer set */
+struct mx_flash_emul_cursor {
+    const struct spi_buf_set *set;
+    size_t idx;
+    size_t off;
+};
+
+static size_t mx_flash_emul_set_len(const struct spi_buf_set *set)
+{
+    size_t len = 0;
+
+    if (set) {
+        for (size_t i = 0; i < set->count; i++) {
+            len += set->buffers[i].len;
+        }
+    }
+
+    return len;
+}
+
+static void mx_flash_emul_cursor_step(struct mx_flash_emul_cursor *cur, uint8_t **byte)
+{
+    *byte = NULL;
+
+    while (cur->set && cur->idx < cur->set->count) {
+        const struct spi_buf *buf = &cur->set->buffers[cur->idx];
+
+        if (cur->off < buf->len) {
+            if (buf->buf) {
+                *byte = (uint8_t *)buf->buf + cur->off;
+            }
+            cur->off++;
+            return;
+        }
+
+        cur->idx++;
+        cur->off = 0;
+    }
+}
+
+/* Clock one byte: return the byte sent by the host, drive out to the host */
+static uint8_t mx_flash_emul_xfer(struct mx_flash_emul_cursor *tx,
+                                  struct mx_flash_emul_cursor *rx, uint8_t out)
+{
+    uint8_t *in_byte, *out_byte;
+
+    mx_flash_emul_cursor_step(tx, &in_byte);
+    mx_flash_emul_cursor_step(rx, &out_byte);
+
+    if (out_byte) {
+        *out_byte = out;
+    }
+
+    return in_byte ? *in_byte : 0xFF;
+}
+
+static uint64_t mx_flash_emul_now_us(void)
+{
+    return k_ticks_to_us_floor64(k_uptime_ticks());
+}
+
+static void mx_flash_emul_update_status(struct mx_flash_emul_data *data)
+{
+    if ((data->status & BIT(MX25_STATUS_WIP_BIT)) &&
+        mx_flash_emul_now_us() >= data->busy_until_us) {
+        data->status &= ~(BIT(MX25_STATUS_WIP_BIT) | BIT(MX25_STATUS_WEL_BIT));
+    }
+}
+
+static void mx_flash_emul_start_busy(struct mx_flash_emul_data *data, uint32_t duration_us)
+{
+    data->stats.busy_us += duration_us;
+    data->busy_until_us = mx_flash_emul_now_us() + (data->timing ? duration_us : 0);
+    data->status |= BIT(MX25_STATUS_WIP_BIT);
+}
+
+static uint32_t mx_flash_emul_read_addr(struct mx_flash_emul_cursor *tx,
+                                        struct mx_flash_emul_cursor *rx)
+{
+    uint32_t addr = 0;
+
+    for (int i = 0; i < 3; i++) {
+        addr = (addr << 8) | mx_flash_emul_xfer(tx, rx, 0xFF);
+    }
+
+    return addr;
+}
+
+static void mx_flash_emul_erase(const struct emul *target, uint32_t addr,
+                                uint32_t size, uint32_t duration_us)
+{
+    const struct mx_flash_emul_config *config = target->cfg;
+    struct mx_flash_emul_data *data = target->data;
+
+    addr = (addr % config->size) & ~(size - 1);
+    memset(&config->mem[addr], 0xFF, size);
+    mx_flash_emul_start_busy(data, duration_us);
+}
+
+static int mx_flash_emul_io(const struct emul *target, const struct spi_config *spi_cfg,
+                            const struct spi_buf_set *tx_bufs,
+                            const struct spi_buf_set *rx_bufs)
+{
+    const struct mx_flash_emul_config *config = target->cfg;
+    struct mx_flash_emul_data *data = target->data;
+    struct mx_flash_emul_cursor tx = {.set = tx_bufs};
+    struct mx_flash_emul_cursor rx = {.set = rx_bufs};
+    size_t len = MAX(mx_flash_emul_set_len(tx_bufs), mx_flash_emul_set_len(rx_bufs));
+    uint32_t addr;
+    uint8_t cmd;
+
+    ARG_UNUSED(spi_cfg);
+
+    if (len == 0) {
+        return 0;
+    }
+
+    cmd = mx_flash_emul_xfer(&tx, &rx, 0xFF);
+    len--;
+    mx_flash_emul_update_status(data);
+
+    /* Deep power-down ignores everything but release */
+    if (data->power_down && cmd != MX25_CMD_RELEASE_POWER_DOWN) {
+        data->stats.rejected++;
+        goto drain;
+    }
+
+    /* A busy chip only answers status reads */
+    if ((data->status & BIT(MX25_STATUS_WIP_BIT)) && cmd != MX25_CMD_READ_STATUS) {
+        data->stats.rejected++;
+        goto drain;
+    }
+
+    switch (cmd) {
+    case MX25_CMD_READ_STATUS:
+        data->stats.status_polls++;
+        if (data->status & BIT(MX25_STATUS_WIP_BIT)) {
+            data->stats.busy_polls++;
+        }
+        while (len > 0) {
+            mx_flash_emul_xfer(&tx, &rx, data->status);
+            len--;
+        }
+        break;
+
+    case MX25_CMD_WRITE_ENABLE:
+        data->status |= BIT(MX25_STATUS_WEL_BIT);
+        break;
+
+    case MX25_CMD_WRITE_DISABLE:
+        data->status &= ~BIT(MX25_STATUS_WEL_BIT);
+        break;
+
+    case MX25_CMD_READ_ID: {
+        static const uint8_t id[] = {MX25_EMUL_ID_MANUFACTURER,
+                                     MX25_EMUL_ID_TYPE,
+                                     MX25_EMUL_ID_DENSITY};
+
+        for (size_t i = 0; len > 0; i++, len--) {
+            mx_flash_emul_xfer(&tx, &rx, id[i % ARRAY_SIZE(id)]);
+        }
+        break;
+    }
+
+    case MX25_CMD_READ_DATA:
+    case MX25_CMD_FAST_READ:
+        if (len < 3) {
+            break;
+        }
+        addr = mx_flash_emul_read_addr(&tx, &rx);
+        len -= 3;
+        if (cmd == MX25_CMD_FAST_READ && len > 0) {
+            mx_flash_emul_xfer(&tx, &rx, 0xFF);
+            len--;
+        }
+        data->stats.reads++;
+        data->stats.read_bytes += len;
+        while (len > 0) {
+            mx_flash_emul_xfer(&tx, &rx, config->mem[addr % config->size]);
+            addr++;
+            len--;
+        }
+        break;
+
+    case MX25_CMD_READ_SFDP:
+        if (len < 4) {
+            break;
+        }
+        addr = mx_flash_emul_read_addr(&tx, &rx);
+        mx_flash_emul_xfer(&tx, &rx, 0xFF); /* Dummy byte */
+        len -= 4;
+        while (len > 0) {
+            mx_flash_emul_xfer(&tx, &rx,
+                               addr < sizeof(data->sfdp) ? data->sfdp[addr] : 0xFF);
+            addr++;
+            len--;
+        }
+        break;
+
+    case MX25_CMD_PAGE_PROGRAM: {
+        if (!(data->status & BIT(MX25_STATUS_WEL_BIT)) || len < 3) {
+            data->stats.rejected++;
+            break;
+        }
+        addr = mx_flash_emul_read_addr(&tx, &rx) % config->size;
+        len -= 3;
+
+        /* Data wraps within the page, programming only clears bits */
+        uint32_t page = addr & ~(MX25_PAGE_SIZE - 1);
+        uint32_t column = addr & (MX25_PAGE_SIZE - 1);
+
+        data->stats.programs++;
+        data->stats.program_bytes += MIN(len, MX25_PAGE_SIZE);
+        while (len > 0) {
+            config->mem[page + column] &= mx_flash_emul_xfer(&tx, &rx, 0xFF);
+            column = (column + 1) & (MX25_PAGE_SIZE - 1);
+            len--;
+        }
+        mx_flash_emul_start_busy(data, MX25_EMUL_PAGE_PROGRAM_US);
+        break;
+    }
+
+    case MX25_CMD_SECTOR_ERASE:
+    case MX25_CMD_BLOCK_ERASE_32K:
+    case MX25_CMD_BLOCK_ERASE_64K:
+        if (!(data->status & BIT(MX25_STATUS_WEL_BIT)) || len < 3) {
+            data->stats.rejected++;
+            break;
+        }
+        addr = mx_flash_emul_read_addr(&tx, &rx);
+        len -= 3;
+        if (cmd == MX25_CMD_SECTOR_ERASE) {
+            data->stats.sector_erases++;
+            mx_flash_emul_erase(target, addr, MX25_SECTOR_SIZE, MX25_EMUL_SECTOR_ERASE_US);
+        } else if (cmd == MX25_CMD_BLOCK_ERASE_32K) {
+            data->stats.block_erases++;
+            mx_flash_emul_erase(target, addr, MX25_BLOCK_SIZE_32K, MX25_EMUL_BLOCK32_ERASE_US);
+        } else {
+            data->stats.block_erases++;
+            mx_flash_emul_erase(target, addr, MX25_BLOCK_SIZE_64K, MX25_EMUL_BLOCK64_ERASE_US);
+        }
+        break;
+
+    case MX25_CMD_CHIP_ERASE:
+        if (!(data->status & BIT(MX25_STATUS_WEL_BIT))) {
+            data->stats.rejected++;
+            break;
+        }
+        data->stats.chip_erases++;
+        memset(config->mem, 0xFF, config->size);
+        mx_flash_emul_start_busy(data, MX25_EMUL_CHIP_ERASE_US);
+        break;
+
+    case MX25_CMD_POWER_DOWN:
+        data->power_down = true;
+        break;
+
+    case MX25_CMD_RELEASE_POWER_DOWN:
+        data->power_down = false;
+        break;
+
+    default:
+        LOG_DBG("Unsupported command 0x%02x", cmd);
+        data->stats.rejected++;
+        break;
+    }
+
+drain:
+    while (len > 0) {
+        mx_flash_emul_xfer(&tx, &rx, 0xFF);
+        len--;
+    }
+
+    return 0;
+}
+
+/*
+ * Build a JESD216B table for an MX25R6435F-like part. Timings are
+ * encoded as the closest representable values to the modelled ones.
+ */
+static void mx_flash_emul_build_sfdp(struct mx_flash_emul_data *data, uint32_t size)
+{
+    uint32_t bfpt[MX_FLASH_EMUL_BFPT_DWORDS];
+    uint8_t *hdr = data->sfdp;
+
+    memset(data->sfdp, 0xFF, sizeof(data->sfdp));
+
+    /* SFDP header: signature, rev 1.6, one parameter header */
+    sys_put_le32(MX25_SFDP_SIGNATURE, &hdr[0]);
+    hdr[4] = 0x06;
+    hdr[5] = 0x01;
+    hdr[6] = 0x00;
+    hdr[7] = 0xFF;
+
+    /* BFPT parameter header */
+    hdr[8] = MX25_SFDP_BFPT_ID_LSB;
+    hdr[9] = 0x06;
+    hdr[10] = 0x01;
+    hdr[11] = MX_FLASH_EMUL_BFPT_DWORDS;
+    hdr[12] = MX_FLASH_EMUL_BFPT_ADDR & 0xFF;
+    hdr[13] = (MX_FLASH_EMUL_BFPT_ADDR >> 8) & 0xFF;
+    hdr[14] = (MX_FLASH_EMUL_BFPT_ADDR >> 16) & 0xFF;
+    hdr[15] = MX25_SFDP_BFPT_ID_MSB;
+
+    memset(bfpt, 0xFF, sizeof(bfpt));
+    bfpt[0] = 0xFFF120E5;                 /* 4 KB erase supported, opcode 0x20 */
+    bfpt[1] = size * 8 - 1;               /* Density in bits, minus one */
+    bfpt[7] = 0x520F200C;                 /* 4 KB / 0x20, 32 KB / 0x52 */
+    bfpt[8] = 0x00FFD810;                 /* 64 KB / 0xD8, type 4 unused */
+    bfpt[9] = 2 |                         /* Max erase time = 6 x typical */
+              ((BIT(5) | 2) << 4) |       /* 4 KB: 3 x 16 ms */
+              ((BIT(5) | 12) << 11) |     /* 32 KB: 13 x 16 ms */
+              ((BIT(5) | 24) << 18);      /* 64 KB: 25 x 16 ms */
+    bfpt[10] = 5 |                        /* Max program time = 12 x typical */
+               (8 << 4) |                 /* 256 byte page */
+               (13 << 8) | BIT(13) |      /* Page program: 14 x 64 us */
+               (12 << 24) | (2 << 29);    /* Chip erase: 13 x 4 s */
+
+    for (int i = 0; i < MX_FLASH_EMUL_BFPT_DWORDS; i++) {
+        sys_put_le32(bfpt[i], &data->sfdp[MX_FLASH_EMUL_BFPT_ADDR + i * 4]);
+    }
+}
+
+void mx_flash_emul_stats_get(const struct emul *target, struct mx_flash_emul_stats *stats)
+{
+    const struct mx_flash_emul_data *data = target->data;
+
+    *stats = data->stats;
+}
+
+void mx_flash_emul_stats_reset(const struct emul *target)
+{
+    struct mx_flash_emul_data *data = target->data;
+
+    memset(&data->stats, 0, sizeof(data->stats));
+}
+
+void mx_flash_emul_timing_set(const struct emul *target, bool enable)
+{
+    struct mx_flash_emul_data *data = target->data;
+
+    data->timing = enable;
+}
+
+uint8_t *mx_flash_emul_get_mem(const struct emul *target, size_t *size)
+{
+    const struct mx_flash_emul_config *config = target->cfg;
+
+    if (size) {
+        *size = config->size;
+    }
+
+    return config->mem;
+}
+
+static int mx_flash_emul_init(const struct emul *target, const struct device *parent)
+{
+    const struct mx_flash_emul_config *config = target->cfg;
+    struct mx_flash_emul_data *data = target->data;
+
+    ARG_UNUSED(parent);
+
+    memset(config->mem, 0xFF, config->size);
+    memset(&data->stats, 0, sizeof(data->stats));
+    data->status = 0;
+    data->power_down = false;
+    data->timing = IS_ENABLED(CONFIG_MX25_FLASH_EMUL_TIMING);
+    data->busy_until_us = 0;
+    mx_flash_emul_build_sfdp(data, config->size);
+
+    return 0;
+}
+
+static struct spi_emul_api mx_flash_emul_api = {
+    .io = mx_flash_emul_io,
+};
+
+/* Emulator instantiation */
+#define MX_FLASH_EMUL_INIT(n)                                            \
+    static uint8_t mx_flash_emul_mem_##n[DT_INST_PROP(n, size)];         \
+    static struct mx_flash_emul_data mx_flash_emul_data_##n;             \
+                                                                         \
+    static const struct mx_flash_emul_config mx_flash_emul_config_##n = { \
+        .mem = mx_flash_emul_mem_##n,                                    \
+        .size = DT_INST_PROP(n, size),                                   \
+    };                                                                   \
+                                                                         \
+    EMUL_DT_INST_DEFINE(n,                                               \
+                        mx_flash_emul_init,                              \
+                        &mx_flash_emul_data_##n,                         \
+                        &mx_flash_emul_config_##n,                       \
+                        &mx_flash_emul_api,                              \
+                        NULL);
+
+DT_INST_FOREACH_STATUS_OKAY(MX_FLASH_EMUL_INIT)
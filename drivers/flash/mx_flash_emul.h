@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_DRIVERS_FLASH_MX_FLASH_EMUL_H_
+#define ZEPHYR_DRIVERS_FLASH_MX_FLASH_EMUL_H_
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/emul.h>
+
+/* JEDEC ID reported by the emulator (MX25R6435F) */
+#define MX25_EMUL_ID_MANUFACTURER  0xC2
+#define MX25_EMUL_ID_TYPE          0x28
+#define MX25_EMUL_ID_DENSITY       0x17
+
+/* Typical operation durations (in us) */
+#define MX25_EMUL_PAGE_PROGRAM_US  850
+#define MX25_EMUL_SECTOR_ERASE_US  40000
+#define MX25_EMUL_BLOCK32_ERASE_US 200000
+#define MX25_EMUL_BLOCK64_ERASE_US 400000
+#define MX25_EMUL_CHIP_ERASE_US    50000000
+
+/* Operation counters */
+struct mx_flash_emul_stats {
+    uint32_t reads;           /* Read data and fast read commands */
+    uint32_t read_bytes;      /* Bytes clocked out by read commands */
+    uint32_t programs;        /* Accepted page programs */
+    uint32_t program_bytes;   /* Bytes programmed */
+    uint32_t sector_erases;   /* Accepted 4 KB erases */
+    uint32_t block_erases;    /* Accepted 32 KB and 64 KB erases */
+    uint32_t chip_erases;     /* Accepted chip erases */
+    uint32_t status_polls;    /* Read status commands */
+    uint32_t busy_polls;      /* Read status commands returning WIP set */
+    uint32_t rejected;        /* Commands ignored while busy, powered down or without WEL */
+    uint64_t busy_us;         /* Total modelled program and erase time */
+};
+
+/**
+ * @brief Get emulator operation counters
+ *
+ * @param target Pointer to emulator
+ * @param stats Pointer to store counters
+ */
+void mx_flash_emul_stats_get(const struct emul *target, struct mx_flash_emul_stats *stats);
+
+/**
+ * @brief Reset emulator operation counters
+ *
+ * @param target Pointer to emulator
+ */
+void mx_flash_emul_stats_reset(const struct emul *target);
+
+/**
+ * @brief Enable or disable operation timing
+ *
+ * With timing disabled, program and erase complete immediately.
+ *
+ * @param target Pointer to emulator
+ * @param enable true to model typical durations, false for instant completion
+ */
+void mx_flash_emul_timing_set(const struct emul *target, bool enable);
+
+/**
+ * @brief Get direct access to the emulated array
+ *
+ * @param target Pointer to emulator
+ * @param size Pointer to store array size in bytes
+ * @return Pointer to the emulated memory
+ */
+uint8_t *mx_flash_emul_get_mem(const struct emul *target, size_t *size);
+
+#endif /* ZEPHYR_DRIVERS_FLASH_MX_FLASH_EMUL_H_ */
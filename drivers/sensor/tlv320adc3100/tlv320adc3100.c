@@ -12,7 +12,7 @@ LOG_MODULE_REGISTER(tlv320adc3100, CONFIG_SENSOR_LOG_LEVEL);
 
 struct tlv320adc3100_data tlv320adc3100_driver_data;
 
-static int tlv320adc3100_reg_write(const struct device *dev, uint8_t reg, uint8_t value)
+int tlv320adc3100_reg_write(const struct device *dev, uint8_t reg, uint8_t value)
 {
     const struct tlv320adc3100_config *config = dev->config;
     uint8_t buf[2] = {reg, value};
@@ -20,14 +20,14 @@ static int tlv320adc3100_reg_write(const struct device *dev, uint8_t reg, uint8_
     return i2c_write_dt(&config->i2c, buf, sizeof(buf));
 }
 
-static int tlv320adc3100_reg_read(const struct device *dev, uint8_t reg, uint8_t *value)
+int tlv320adc3100_reg_read(const struct device *dev, uint8_t reg, uint8_t *value)
 {
     const struct tlv320adc3100_config *config = dev->config;
 
     return i2c_write_read_dt(&config->i2c, &reg, 1, value, 1);
 }
 
-static int tlv320adc3100_reset(const struct device *dev)
+int tlv320adc3100_reset(const struct device *dev)
 {
     const struct tlv320adc3100_config *config = dev->config;
     int ret;
@@ -50,6 +50,24 @@ static int tlv320adc3100_reset(const struct device *dev)
     return 0;
 }
 
+static int tlv320adc3100_write_volume(const struct device *dev, int8_t volume)
+{
+    struct tlv320adc3100_data *data = dev->data;
+    // 7-bit two's complement in 0.5 dB steps
+    uint8_t value = (uint8_t)(volume * 2) & 0x7F;
+    int ret;
+
+    // Volume registers are on page 0
+    ret = tlv320adc3100_reg_write(dev, TLV320ADC3100_PAGE_CTL, 0);
+    if (ret < 0) return ret;
+    data->current_page = 0;
+
+    ret = tlv320adc3100_reg_write(dev, TLV320ADC3100_LADC_VOL, value);
+    if (ret < 0) return ret;
+
+    return tlv320adc3100_reg_write(dev, TLV320ADC3100_RADC_VOL, value);
+}
+
 static int tlv320adc3100_configure_pll(const struct device *dev)
 {
     int ret;
@@ -111,7 +129,7 @@ static int tlv320adc3100_configure_adc(const struct device *dev)
     if (ret < 0) return ret;
 
     // Set volume
-    ret = tlv320adc3100_reg_write(dev, TLV320ADC3100_LADC_VOL, data->volume + 127);
+    ret = tlv320adc3100_write_volume(dev, data->volume);
     if (ret < 0) return ret;
 
     // Configure gain
@@ -133,13 +151,28 @@ int tlv320adc3100_configure(const struct device *dev, uint8_t channel,
     struct tlv320adc3100_data *data = dev->data;
     
     data->channel = channel;
-    data->volume = volume;
+    data->volume = CLAMP(volume, TLV320ADC3100_VOLUME_MIN_DB, TLV320ADC3100_VOLUME_MAX_DB);
     data->gain = gain;
     data->min6db = min6db;
 
     return tlv320adc3100_configure_adc(dev);
 }
 
+int tlv320adc3100_set_volume(const struct device *dev, int8_t volume)
+{
+    struct tlv320adc3100_data *data = dev->data;
+    int ret;
+
+    volume = CLAMP(volume, TLV320ADC3100_VOLUME_MIN_DB, TLV320ADC3100_VOLUME_MAX_DB);
+
+    // Volume only, routing and clocks stay as configured
+    ret = tlv320adc3100_write_volume(dev, volume);
+    if (ret < 0) return ret;
+
+    data->volume = volume;
+    return 0;
+}
+
 static int tlv320adc3100_init(const struct device *dev)
 {
     const struct tlv320adc3100_config *config = dev->config;
@@ -33,9 +33,9 @@
 #define TLV320ADC3100_IN2R_2_RADC_CTL   0x3A
 #define TLV320ADC3100_IN3L_2_LADC_CTL   0x3B
 #define TLV320ADC3100_IN3R_2_RADC_CTL   0x3C
-#define TLV320ADC3100_LADC_VOL          0x3D
-#define TLV320ADC3100_RADC_VOL          0x3E
 #define TLV320ADC3100_ADC_DIGITAL       0x51
+#define TLV320ADC3100_LADC_VOL          0x53
+#define TLV320ADC3100_RADC_VOL          0x54
 #define TLV320ADC3100_AGC_MAX_GAIN      0x56
 #define TLV320ADC3100_AGC_ATTACK_TIME   0x57
 #define TLV320ADC3100_AGC_DECAY_TIME    0x58
@@ -48,6 +48,10 @@
 #define TLV320ADC3100_RESET_DELAY_MS    1
 #define TLV320ADC3100_STARTUP_DELAY_MS  10
 
+/* ADC digital volume range in dB, page 0, 0.5 dB steps */
+#define TLV320ADC3100_VOLUME_MIN_DB     (-12)
+#define TLV320ADC3100_VOLUME_MAX_DB     20
+
 struct tlv320adc3100_config {
     struct i2c_dt_spec i2c;
     struct gpio_dt_spec reset_gpio;
@@ -86,7 +90,7 @@ int tlv320adc3100_reg_read(const struct device *dev, uint8_t reg, uint8_t *value
  *
  * @param dev Pointer to the device structure
  * @param channel Input channel selection
- * @param volume Volume setting (-127 to 48)
+ * @param volume ADC digital volume in dB (-12 to 20), clamped
  * @param gain Gain setting
  * @param min6db Enable -6dB mode
  * @return 0 if successful, negative errno code on failure
@@ -94,6 +98,18 @@ int tlv320adc3100_reg_read(const struct device *dev, uint8_t reg, uint8_t *value
 int tlv320adc3100_configure(const struct device *dev, uint8_t channel,
                            int8_t volume, uint8_t gain, bool min6db);
 
+/**
+ * @brief Set the ADC volume
+ *
+ * Writes only the left and right ADC digital volume, so it can follow
+ * the signal level while capturing.
+ *
+ * @param dev Pointer to the device structure
+ * @param volume ADC digital volume in dB (-12 to 20), clamped
+ * @return 0 if successful, negative errno code on failure
+ */
+int tlv320adc3100_set_volume(const struct device *dev, int8_t volume);
+
 /**
  * @brief Reset the TLV320ADC3100
  *
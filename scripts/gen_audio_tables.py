@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+"""Generate the constant tables of the audio DSP core (audio_dsp.c).
+
+Writes the Hann window of every configurable FFT size as a C include,
+in both the float layout (int16 to float scale of 1/32768 folded in)
+and Q15. Each format is guarded by the build option that uses it, so
+only the arithmetic in use lands in .rodata. Run by CMake at build
+time, the output is not checked in.
+"""
+
+import argparse
+import math
+import struct
+
+
+def hann(n):
+    """Symmetric Hann window of n points, as the double reference in audio_bench.c"""
+    return [0.5 * (1.0 - math.cos(2.0 * math.pi * i / (n - 1))) for i in range(n)]
+
+
+def f32(value):
+    """Shortest literal that reads back as the same float32"""
+    single = struct.unpack('<f', struct.pack('<f', value))[0]
+    for digits in range(6, 10):
+        text = f"{single:.{digits}g}"
+        if struct.unpack('<f', struct.pack('<f', float(text)))[0] == single:
+            break
+    if 'e' not in text and '.' not in text:
+        text += '.0'
+    return text + 'f'
+
+
+def array(ctype, name, values, per_line):
+    lines = [f"static const {ctype} {name}[{len(values)}] = {{"]
+    for i in range(0, len(values), per_line):
+        lines.append("    " + ", ".join(values[i:i + per_line]) + ",")
+    lines.append("};")
+    return lines
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Audio DSP table generator")
+    parser.add_argument('--min-size', type=int, default=256, help="AUDIO_FFT_SIZE_MIN")
+    parser.add_argument('--max-size', type=int, default=2048, help="AUDIO_FFT_SIZE_MAX")
+    parser.add_argument('--output', required=True, help="Include file to write")
+    args = parser.parse_args()
+
+    sizes = []
+    size = args.min_size
+    while size <= args.max_size:
+        sizes.append(size)
+        size *= 2
+
+    out = [
+        "/* Generated by scripts/gen_audio_tables.py, do not edit */",
+        "",
+        f"#define AUDIO_DSP_TABLE_MIN_SIZE {args.min_size}",
+        f"#define AUDIO_DSP_TABLE_COUNT    {len(sizes)}",
+        "",
+        "#ifdef AUDIO_DSP_USE_F32",
+    ]
+    for n in sizes:
+        values = [f32(w / 32768.0) for w in hann(n)]
+        out += array("float32_t", f"hann_f32_{n}", values, 6)
+    out.append("")
+    out.append("static const float32_t *const hann_f32[AUDIO_DSP_TABLE_COUNT] = {")
+    out += [f"    hann_f32_{n}," for n in sizes]
+    out += ["};", "#endif", "", "#ifdef CONFIG_AUDIO_DSP_Q15"]
+    for n in sizes:
+        values = [str(int(w * 32767.0 + 0.5)) for w in hann(n)]
+        out += array("q15_t", f"hann_q15_{n}", values, 12)
+    out.append("")
+    out.append("static const q15_t *const hann_q15[AUDIO_DSP_TABLE_COUNT] = {")
+    out += [f"    hann_q15_{n}," for n in sizes]
+    out += ["};", "#endif", ""]
+
+    with open(args.output, 'w') as f:
+        f.write("\n".join(out))
+
+
+if __name__ == '__main__':
+    main()
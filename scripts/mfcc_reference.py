@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+"""Host reference of the on-device MFCC (CONFIG_AUDIO_MFCC).
+
+Repeats the firmware pipeline on a 16-bit mono WAV file or a synthetic
+tone: Hann windowed segments with 50% overlap, bin powers of the real
+FFT, triangular mel filters, natural log, mean over all segments and an
+orthonormal DCT-II. Coefficients are printed in the 0.01 units of the
+AUDIO_MFCC measurement. With --expect the device coefficients are
+compared and the exit status is 1 when any differs by more than
+--tolerance. With --output the coefficients are also written as a C
+initializer, the audio benchmark compares against it at run time.
+
+Decimation is not modelled, compare against a build with
+CONFIG_AUDIO_DECIMATION_NONE or pass the decimated rate and samples.
+"""
+
+import argparse
+import cmath
+import math
+import sys
+import wave
+
+# Keeps the log finite for silent bands, as MEL_FLOOR in audio_mfcc.c
+MEL_FLOOR = 1e-10
+
+
+def read_wav(path):
+    """Read a 16-bit mono PCM WAV file, returns (rate, samples)"""
+    with wave.open(path, 'rb') as wav:
+        if wav.getnchannels() != 1 or wav.getsampwidth() != 2:
+            print("Error: need a 16-bit mono PCM WAV file")
+            sys.exit(1)
+        rate = wav.getframerate()
+        data = wav.readframes(wav.getnframes())
+    samples = [int.from_bytes(data[i:i + 2], 'little', signed=True)
+               for i in range(0, len(data), 2)]
+    return rate, samples
+
+
+def tone(rate, freq, amplitude, seconds):
+    """Synthetic sine in int16 samples"""
+    return [int(round(amplitude * math.sin(2 * math.pi * freq * i / rate)))
+            for i in range(int(rate * seconds))]
+
+
+def fft(values):
+    """Radix-2 complex FFT"""
+    n = len(values)
+    if n == 1:
+        return list(values)
+    even = fft(values[0::2])
+    odd = fft(values[1::2])
+    out = [0] * n
+    for k in range(n // 2):
+        t = cmath.exp(-2j * math.pi * k / n) * odd[k]
+        out[k] = even[k] + t
+        out[k + n // 2] = even[k] - t
+    return out
+
+
+def hz_to_mel(hz):
+    return 2595.0 * math.log10(1.0 + hz / 700.0)
+
+
+def mel_to_hz(mel):
+    return 700.0 * (10.0 ** (mel / 2595.0) - 1.0)
+
+
+def mel_filters(rate, fft_size, bands, low, high):
+    """Non-zero weights of each triangular filter as (first bin, weights)"""
+    high = min(high, rate // 2)
+    mel_low = hz_to_mel(low)
+    step = (hz_to_mel(high) - mel_low) / (bands + 1)
+    filters = []
+    for m in range(bands):
+        left, centre, right = (mel_to_hz(mel_low + (m + i) * step) for i in range(3))
+        first, weights = 0, []
+        for k in range(1, fft_size // 2):
+            f = k * rate / fft_size
+            if f <= left or f >= right:
+                continue
+            if not weights:
+                first = k
+            if f < centre:
+                weights.append((f - left) / (centre - left))
+            else:
+                weights.append((right - f) / (right - centre))
+        filters.append((first, weights))
+    return filters
+
+
+def mfcc(samples, rate, fft_size, bands, count, low, high):
+    """Mean cepstrum of all complete segments"""
+    window = [0.5 * (1.0 - math.cos(2 * math.pi * i / (fft_size - 1)))
+              for i in range(fft_size)]
+    filters = mel_filters(rate, fft_size, bands, low, high)
+    log_sum = [0.0] * bands
+    frames = 0
+
+    for start in range(0, len(samples) - fft_size + 1, fft_size // 2):
+        segment = [samples[start + i] / 32768.0 * window[i] for i in range(fft_size)]
+        spectrum = fft(segment)
+        power = [abs(x) ** 2 for x in spectrum[:fft_size // 2]]
+        for m, (first, weights) in enumerate(filters):
+            energy = sum(w * power[first + i] for i, w in enumerate(weights))
+            log_sum[m] += math.log(energy + MEL_FLOOR)
+        frames += 1
+
+    if frames == 0:
+        print("Error: input is shorter than one segment")
+        sys.exit(1)
+
+    mean = [s / frames for s in log_sum]
+    coeff = []
+    for k in range(count):
+        scale = math.sqrt((1.0 if k == 0 else 2.0) / bands)
+        coeff.append(scale * sum(mean[m] * math.cos(math.pi * k * (m + 0.5) / bands)
+                                 for m in range(bands)))
+    return coeff, frames
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Reference MFCC of the audio pipeline")
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument('--wav', help="16-bit mono PCM WAV file")
+    source.add_argument('--tone', type=float, help="Synthetic sine frequency in Hz")
+    parser.add_argument('--rate', type=int, default=16000, help="Sample rate of --tone")
+    parser.add_argument('--amplitude', type=float, default=10000, help="Peak of --tone")
+    parser.add_argument('--seconds', type=float, default=1.0, help="Length of --tone")
+    parser.add_argument('--fft-size', type=int, default=512)
+    parser.add_argument('--mel-bands', type=int, default=20, help="CONFIG_AUDIO_MEL_BANDS")
+    parser.add_argument('--mfcc-count', type=int, default=13, help="CONFIG_AUDIO_MFCC_COUNT")
+    parser.add_argument('--low', type=int, default=100, help="CONFIG_AUDIO_MEL_LOW_HZ")
+    parser.add_argument('--high', type=int, default=4000, help="CONFIG_AUDIO_MEL_HIGH_HZ")
+    parser.add_argument('--expect', help="Device coefficients in 0.01 units, comma separated")
+    parser.add_argument('--tolerance', type=int, default=5,
+                        help="Allowed difference per coefficient in 0.01 units")
+    parser.add_argument('--output', help="Include file to write the coefficients to")
+    args = parser.parse_args()
+
+    if args.wav:
+        rate, samples = read_wav(args.wav)
+    else:
+        rate = args.rate
+        samples = tone(rate, args.tone, args.amplitude, args.seconds)
+
+    coeff, frames = mfcc(samples, rate, args.fft_size, args.mel_bands, args.mfcc_count,
+                         args.low, args.high)
+    reference = [int(round(c * 100)) for c in coeff]
+    print(f"{frames} segments")
+    print(','.join(str(c) for c in reference))
+
+    if args.output:
+        with open(args.output, 'w') as f:
+            f.write("/* Generated by scripts/mfcc_reference.py, do not edit */\n")
+            f.write(', '.join(str(c) for c in reference) + ",\n")
+
+    if args.expect:
+        expect = [int(c) for c in args.expect.split(',')]
+        if len(expect) != len(reference):
+            print(f"Error: expected {len(reference)} coefficients, got {len(expect)}")
+            sys.exit(1)
+        worst = max(abs(e - r) for e, r in zip(expect, reference))
+        print(f"Largest difference {worst}, tolerance {args.tolerance}")
+        if worst > args.tolerance:
+            sys.exit(1)
+
+
+if __name__ == '__main__':
+    main()
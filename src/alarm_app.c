@@ -7,6 +7,7 @@
 #include <zephyr/logging/log.h>
 #include "alarm_app.h"
 #include "flash_fs.h"
+#include "audio_app.h"
 
 LOG_MODULE_REGISTER(alarm_app, CONFIG_APP_LOG_LEVEL);
 
@@ -16,6 +17,9 @@ static struct {
     alarm_callback_t callback;
     ALARM_CONFIG_s config;
     uint32_t active_alarms;
+#ifdef CONFIG_AUDIO_PRETRIGGER
+    int64_t pretrigger_saved[ALARM_AUDIO + 1]; /* Uptime of the last save per alarm type */
+#endif
 } alarm_state;
 
 /* Mutex for alarm state access */
@@ -73,6 +77,73 @@ static bool check_hx711_alarm(const HX711_CONV_s *result, const HX711_ALARM_s *c
     return false;
 }
 
+/*
+ * Audio thresholds are relative to the per-band noise floor, in
+ * 1/AUDIO_LEVEL_SCALE dB, over the bands overlapping FreqMin to FreqMax
+ * (FreqMax 0 for no upper limit): a band more than Max above or Min
+ * below its floor, or band SNRs spread more than Diff apart. A zero
+ * threshold is not checked. One pass over the bands, whose edges the
+ * result carries as they were when it was recorded.
+ */
+static bool check_audio_alarm(const FFT_RESULT_s *result, const AUDIO_ALARM_s *config)
+{
+    const uint16_t freq_max = config->FreqMax ? config->FreqMax : UINT16_MAX;
+    const uint16_t *snr = &result->magnitude[2 * result->band_count];
+    const uint16_t *edges = &result->magnitude[AUDIO_RESULT_EDGES(result->band_count)];
+    int32_t snr_min = INT16_MAX;
+    int32_t snr_max = INT16_MIN;
+
+    /* Tone alarms carry levels without bands */
+    if (result->band_count == 0 || result->band_count > AUDIO_MAX_BANDS) {
+        return false;
+    }
+
+    for (int band = 0; band < result->band_count; band++) {
+        /* Start and end frequency per band */
+        if (edges[2 * band + 1] < config->FreqMin || edges[2 * band] > freq_max) {
+            continue;
+        }
+        snr_min = MIN(snr_min, (int16_t)snr[band]);
+        snr_max = MAX(snr_max, (int16_t)snr[band]);
+    }
+
+    if (snr_min > snr_max) {
+        /* No band in the range */
+        return false;
+    }
+
+    return (config->Max > 0 && snr_max > config->Max) ||
+           (config->Min > 0 && snr_min < -(int32_t)config->Min) ||
+           (config->Diff > 0 && snr_max - snr_min > config->Diff);
+}
+
+/* Deliver an alarm and keep the audio leading up to it */
+static void alarm_notify(alarm_type_t type, const MEASUREMENT_RESULT_s *result)
+{
+    if (alarm_state.callback) {
+        alarm_state.callback(type, result);
+        alarm_state.active_alarms |= BIT(type);
+    }
+
+#ifdef CONFIG_AUDIO_PRETRIGGER
+    int64_t *saved = &alarm_state.pretrigger_saved[type];
+
+    /* An active alarm repeats on every measurement, save it once per holdoff */
+    if (*saved != 0 &&
+        k_uptime_get() - *saved < CONFIG_AUDIO_PRETRIGGER_HOLDOFF * MSEC_PER_SEC) {
+        return;
+    }
+
+    int ret = audio_app_pretrigger_save(result);
+
+    if (ret == 0) {
+        *saved = k_uptime_get();
+    } else if (ret != -ENODATA) {
+        LOG_WRN("Pre-trigger audio not saved: %d", ret);
+    }
+#endif
+}
+
 /* API Implementation */
 int alarm_app_init(alarm_callback_t callback)
 {
@@ -166,16 +237,35 @@ int alarm_app_process(const MEASUREMENT_RESULT_s *result)
             }
             break;
 
+        case AUDIO_ADC:
+            if (alarm_state.config.type == AUDIO_ADC &&
+                check_audio_alarm(&result->result.fft, &alarm_state.config.thr.audio)) {
+                alarm_triggered = true;
+                alarm_type = ALARM_AUDIO;
+            }
+            break;
+
         default:
             break;
     }
 
     /* Handle alarm if triggered */
-    if (alarm_triggered && alarm_state.callback) {
-        alarm_state.callback(alarm_type, result);
-        alarm_state.active_alarms |= BIT(alarm_type);
+    if (alarm_triggered) {
+        alarm_notify(alarm_type, result);
+    }
+
+    k_mutex_unlock(&alarm_mutex);
+    return 0;
+}
+
+int alarm_app_raise(alarm_type_t type, const MEASUREMENT_RESULT_s *result)
+{
+    if (!result || !alarm_state.enabled) {
+        return -EINVAL;
     }
 
+    k_mutex_lock(&alarm_mutex, K_FOREVER);
+    alarm_notify(type, result);
     k_mutex_unlock(&alarm_mutex);
     return 0;
 }
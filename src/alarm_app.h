@@ -55,6 +55,18 @@ int alarm_app_get_config(ALARM_CONFIG_s *config);
  */
 int alarm_app_process(const MEASUREMENT_RESULT_s *result);
 
+/**
+ * @brief Raise an alarm detected outside of alarm_app_process()
+ *
+ * Used by subsystems that evaluate their own signal, such as audio tone
+ * detection. Ignored while the alarm system is disabled.
+ *
+ * @param type Alarm type
+ * @param result Measurement that caused the alarm
+ * @return 0 on success, -EINVAL if disabled or result is NULL
+ */
+int alarm_app_raise(alarm_type_t type, const MEASUREMENT_RESULT_s *result);
+
 /**
  * @brief Enable or disable alarm system
  *
@@ -0,0 +1,149 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/byteorder.h>
+#include <string.h>
+#include "audio_adpcm.h"
+
+/* IMA-ADPCM quantiser step sizes */
+static const int16_t step_table[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+    19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+    130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+    5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+/* Step index change per code magnitude */
+static const int8_t index_table[8] = {
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+static uint8_t encode_sample(audio_adpcm_t *enc, int16_t sample)
+{
+    int32_t step = step_table[enc->step_index];
+    int32_t diff = sample - enc->predictor;
+    int32_t vpdiff = step >> 3;
+    uint8_t code = 0;
+
+    if (diff < 0) {
+        code = 8;
+        diff = -diff;
+    }
+
+    /* Successive approximation of diff / step in three bits */
+    if (diff >= step) {
+        code |= 4;
+        diff -= step;
+        vpdiff += step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        code |= 2;
+        diff -= step;
+        vpdiff += step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        code |= 1;
+        vpdiff += step;
+    }
+
+    /* Track the decoder so errors do not accumulate */
+    enc->predictor += (code & 8) ? -vpdiff : vpdiff;
+    enc->predictor = CLAMP(enc->predictor, INT16_MIN, INT16_MAX);
+    enc->step_index = CLAMP(enc->step_index + index_table[code & 7], 0, 88);
+
+    return code;
+}
+
+void audio_adpcm_init(audio_adpcm_t *enc)
+{
+    enc->predictor = 0;
+    enc->step_index = 0;
+    enc->fill = 0;
+}
+
+size_t audio_adpcm_encode(audio_adpcm_t *enc, const int16_t *samples, size_t count)
+{
+    size_t used = 0;
+
+    if (enc->fill == AUDIO_ADPCM_BLOCK_SAMPLES) {
+        /* Previous block was stored */
+        enc->fill = 0;
+    }
+
+    if (enc->fill == 0 && count > 0) {
+        /* Block header restarts the decoder at the first sample */
+        enc->predictor = samples[0];
+        sys_put_le16((uint16_t)samples[0], &enc->block[0]);
+        enc->block[2] = enc->step_index;
+        enc->block[3] = 0;
+        enc->fill = 1;
+        used = 1;
+    }
+
+    while (used < count && enc->fill < AUDIO_ADPCM_BLOCK_SAMPLES) {
+        uint8_t code = encode_sample(enc, samples[used++]);
+        uint8_t *byte = &enc->block[4 + (enc->fill - 1) / 2];
+
+        if ((enc->fill - 1) % 2 == 0) {
+            *byte = code;
+        } else {
+            *byte |= code << 4;
+        }
+        enc->fill++;
+    }
+
+    return used;
+}
+
+bool audio_adpcm_flush(audio_adpcm_t *enc)
+{
+    if (enc->fill == 0 || enc->fill == AUDIO_ADPCM_BLOCK_SAMPLES) {
+        return false;
+    }
+
+    /* Pad with zero codes, a half used last byte already has a zero high nibble */
+    size_t used = 4 + enc->fill / 2;
+
+    memset(&enc->block[used], 0, AUDIO_ADPCM_BLOCK_SIZE - used);
+    enc->fill = AUDIO_ADPCM_BLOCK_SAMPLES;
+    return true;
+}
+
+void audio_adpcm_wav_header(uint8_t *header, uint32_t sample_rate, uint32_t samples,
+                            uint32_t data_size)
+{
+    /* RIFF header */
+    memcpy(&header[0], "RIFF", 4);
+    sys_put_le32(AUDIO_ADPCM_WAV_HEADER_SIZE - 8 + data_size, &header[4]);
+    memcpy(&header[8], "WAVE", 4);
+
+    /* IMA-ADPCM format chunk */
+    memcpy(&header[12], "fmt ", 4);
+    sys_put_le32(20, &header[16]);
+    sys_put_le16(0x0011, &header[20]);    /* WAVE_FORMAT_IMA_ADPCM */
+    sys_put_le16(1, &header[22]);         /* Mono */
+    sys_put_le32(sample_rate, &header[24]);
+    sys_put_le32(sample_rate * AUDIO_ADPCM_BLOCK_SIZE / AUDIO_ADPCM_BLOCK_SAMPLES, &header[28]);
+    sys_put_le16(AUDIO_ADPCM_BLOCK_SIZE, &header[32]);
+    sys_put_le16(4, &header[34]);         /* Bits per sample */
+    sys_put_le16(2, &header[36]);         /* Extra format bytes */
+    sys_put_le16(AUDIO_ADPCM_BLOCK_SAMPLES, &header[38]);
+
+    /* Sample count, the last block may be padded */
+    memcpy(&header[40], "fact", 4);
+    sys_put_le32(4, &header[44]);
+    sys_put_le32(samples, &header[48]);
+
+    memcpy(&header[52], "data", 4);
+    sys_put_le32(data_size, &header[56]);
+}
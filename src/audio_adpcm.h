@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef AUDIO_ADPCM_H
+#define AUDIO_ADPCM_H
+
+#include <zephyr/kernel.h>
+
+/*
+ * IMA-ADPCM blocks as stored in WAV files (format tag 0x0011). Each block
+ * starts with the first sample and step index, followed by 4-bit codes
+ * of the remaining samples, low nibble first. One block fills a 256 byte
+ * flash page.
+ */
+#define AUDIO_ADPCM_BLOCK_SIZE    256
+#define AUDIO_ADPCM_BLOCK_SAMPLES ((AUDIO_ADPCM_BLOCK_SIZE - 4) * 2 + 1)  /* 505 */
+#define AUDIO_ADPCM_WAV_HEADER_SIZE 60
+
+/* Streaming encoder state */
+typedef struct {
+    int32_t predictor;    /* Last decoded sample */
+    uint8_t step_index;   /* Index into the step table */
+    uint16_t fill;        /* Samples in the current block */
+    uint8_t block[AUDIO_ADPCM_BLOCK_SIZE];
+} audio_adpcm_t;
+
+/**
+ * @brief Reset encoder for a new stream
+ *
+ * @param enc Encoder state
+ */
+void audio_adpcm_init(audio_adpcm_t *enc);
+
+/**
+ * @brief Encode samples into the current block
+ *
+ * Stops when the block is complete, the caller stores enc->block once
+ * enc->fill reaches AUDIO_ADPCM_BLOCK_SAMPLES and calls again with the
+ * remaining samples.
+ *
+ * @param enc Encoder state
+ * @param samples Sample buffer
+ * @param count Number of samples
+ * @return Number of samples consumed
+ */
+size_t audio_adpcm_encode(audio_adpcm_t *enc, const int16_t *samples, size_t count);
+
+/**
+ * @brief Complete a partial last block
+ *
+ * Pads the block with zero codes, the WAV fact chunk holds the real
+ * sample count.
+ *
+ * @param enc Encoder state
+ * @return true if a block is ready in enc->block, false if it was empty
+ */
+bool audio_adpcm_flush(audio_adpcm_t *enc);
+
+/**
+ * @brief Build the WAV header of a mono IMA-ADPCM stream
+ *
+ * @param header Buffer of AUDIO_ADPCM_WAV_HEADER_SIZE bytes
+ * @param sample_rate Sample rate in Hz
+ * @param samples Number of samples in the stream
+ * @param data_size Bytes of ADPCM blocks following the header
+ */
+void audio_adpcm_wav_header(uint8_t *header, uint32_t sample_rate, uint32_t samples,
+                            uint32_t data_size);
+
+#endif /* AUDIO_ADPCM_H */
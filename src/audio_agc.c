@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/logging/log.h>
+#include "audio_agc.h"
+#include "tlv320adc3100.h"
+
+LOG_MODULE_REGISTER(audio_agc, CONFIG_APP_LOG_LEVEL);
+
+#define CODEC_NODE DT_COMPAT_GET_ANY_STATUS_OKAY(ti_tlv320adc3100)
+
+/* ADC digital volume range of the codec in dB */
+#define CODEC_VOLUME_MIN TLV320ADC3100_VOLUME_MIN_DB
+#define CODEC_VOLUME_MAX TLV320ADC3100_VOLUME_MAX_DB
+
+BUILD_ASSERT(CONFIG_AUDIO_AGC_MIN_DB <= CONFIG_AUDIO_AGC_MAX_DB,
+             "AUDIO_AGC_MIN_DB exceeds AUDIO_AGC_MAX_DB");
+
+/* Codec gain loop state */
+static struct {
+    const struct device *codec;
+    int8_t volume;            /* Applied ADC volume in dB */
+    uint8_t settle;           /* Blocks possibly captured before the last change */
+    int32_t peak_limit;       /* CONFIG_AUDIO_AGC_PEAK_DBFS in LSB */
+
+    /* RMS window */
+    uint64_t energy;
+    uint32_t samples;
+
+    /* Measurement statistics */
+    uint32_t changes;
+    uint32_t clipped;
+    uint32_t blocks;
+    int64_t volume_sum;
+} agc;
+
+static int apply_volume(int8_t volume)
+{
+    int ret;
+
+    if (!agc.codec) {
+        return -ENODEV;
+    }
+
+    ret = tlv320adc3100_set_volume(agc.codec, volume);
+    if (ret < 0) {
+        LOG_ERR("Failed to set ADC volume: %d", ret);
+        return ret;
+    }
+
+    LOG_DBG("ADC volume %d -> %d dB", agc.volume, volume);
+    agc.volume = volume;
+    /* Every block in the I2S ring may hold audio at the previous volume */
+    agc.settle = CONFIG_AUDIO_BLOCK_COUNT;
+    agc.energy = 0;
+    agc.samples = 0;
+    return 0;
+}
+
+int audio_agc_init(int8_t volume)
+{
+    agc.peak_limit = (int32_t)(32768.0f * powf(10.0f, CONFIG_AUDIO_AGC_PEAK_DBFS / 20.0f));
+    agc.volume = CLAMP(volume, CODEC_VOLUME_MIN, CODEC_VOLUME_MAX);
+
+    agc.codec = DEVICE_DT_GET(CODEC_NODE);
+    if (!device_is_ready(agc.codec)) {
+        agc.codec = NULL;
+        return -ENODEV;
+    }
+
+    return tlv320adc3100_configure(agc.codec, DT_PROP(CODEC_NODE, channel_default),
+                                   agc.volume, DT_PROP(CODEC_NODE, gain_default),
+                                   DT_PROP(CODEC_NODE, min6db_default));
+}
+
+int audio_agc_set_volume(int8_t volume)
+{
+    return apply_volume(CLAMP(volume, CODEC_VOLUME_MIN, CODEC_VOLUME_MAX));
+}
+
+int8_t audio_agc_get_volume(void)
+{
+    return agc.volume;
+}
+
+void audio_agc_reset(void)
+{
+    agc.changes = 0;
+    agc.clipped = 0;
+    agc.blocks = 0;
+    agc.volume_sum = 0;
+}
+
+bool audio_agc_process(const int16_t *samples, size_t count, bool adapt)
+{
+    uint64_t energy = 0;
+    int32_t peak = 0;
+    int target;
+
+    agc.blocks++;
+    agc.volume_sum += agc.volume;
+
+    if (agc.settle > 0) {
+        /* Levels of older blocks would steer the loop twice */
+        agc.settle--;
+        return false;
+    }
+
+    if (!adapt || !agc.codec) {
+        return true;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        energy += (int32_t)samples[i] * samples[i];
+        peak = MAX(peak, abs(samples[i]));
+    }
+
+    if (peak > agc.peak_limit) {
+        /* Near clipping, attack without waiting for the window */
+        agc.clipped++;
+        target = agc.volume - CONFIG_AUDIO_AGC_STEP_DB;
+    } else {
+        agc.energy += energy;
+        agc.samples += count;
+        if (agc.samples < CONFIG_AUDIO_AGC_RELEASE_MS * (AUDIO_SAMPLE_RATE / 1000)) {
+            return true;
+        }
+
+        /* RMS level of the window in dBFS */
+        float level = 10.0f * log10f((float)agc.energy / agc.samples /
+                                         (32768.0f * 32768.0f) + 1e-12f);
+        float error = CONFIG_AUDIO_AGC_TARGET_DBFS - level;
+
+        agc.energy = 0;
+        agc.samples = 0;
+
+        if (fabsf(error) <= CONFIG_AUDIO_AGC_HYSTERESIS_DB) {
+            return true;
+        }
+
+        target = agc.volume + CLAMP((int)lroundf(error), -CONFIG_AUDIO_AGC_STEP_DB,
+                                    CONFIG_AUDIO_AGC_STEP_DB);
+    }
+
+    target = CLAMP(target, CONFIG_AUDIO_AGC_MIN_DB, CONFIG_AUDIO_AGC_MAX_DB);
+    if (target != agc.volume && apply_volume(target) == 0) {
+        agc.changes++;
+        /* This block was captured at the previous volume too */
+        return false;
+    }
+
+    return true;
+}
+
+void audio_agc_get_stats(audio_stats_t *stats)
+{
+    stats->agc_changes = agc.changes;
+    stats->agc_clipped_blocks = agc.clipped;
+    stats->agc_volume_mean = agc.blocks ?
+        (int32_t)(agc.volume_sum * AUDIO_LEVEL_SCALE / (int64_t)agc.blocks) :
+        agc.volume * AUDIO_LEVEL_SCALE;
+}
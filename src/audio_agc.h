@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef AUDIO_AGC_H
+#define AUDIO_AGC_H
+
+#include <zephyr/kernel.h>
+#include "audio_app.h"
+
+/**
+ * @brief Configure the TLV320ADC3100 and apply a start volume
+ *
+ * @param volume ADC volume in dB
+ * @return 0 on success, -ENODEV if the codec is not ready, negative errno
+ *         code on failure
+ */
+int audio_agc_init(int8_t volume);
+
+/**
+ * @brief Set the ADC volume, the loop continues from it
+ *
+ * Shares the loop state with audio_agc_process(), call it from the same
+ * thread.
+ *
+ * @param volume ADC volume in dB, clamped to the codec range
+ * @return 0 on success, negative errno code on failure
+ */
+int audio_agc_set_volume(int8_t volume);
+
+/**
+ * @brief Get the applied ADC volume
+ *
+ * @return ADC volume in dB
+ */
+int8_t audio_agc_get_volume(void);
+
+/**
+ * @brief Clear the measurement statistics
+ */
+void audio_agc_reset(void);
+
+/**
+ * @brief Measure a captured block and adjust the volume
+ *
+ * Tracks peak and RMS level. A peak above CONFIG_AUDIO_AGC_PEAK_DBFS
+ * lowers the volume at once, the RMS level averaged over
+ * CONFIG_AUDIO_AGC_RELEASE_MS moves it towards CONFIG_AUDIO_AGC_TARGET_DBFS
+ * when it is more than CONFIG_AUDIO_AGC_HYSTERESIS_DB away. Steps are at
+ * most CONFIG_AUDIO_AGC_STEP_DB.
+ *
+ * @param samples Sample buffer
+ * @param count Number of samples
+ * @param adapt true to adjust the volume, false to only track settling
+ * @return true if the block was captured at the applied volume, false
+ *         while blocks queued before the last change drain
+ */
+bool audio_agc_process(const int16_t *samples, size_t count, bool adapt);
+
+/**
+ * @brief Get gain statistics since audio_agc_reset()
+ *
+ * Fills the AGC fields of the statistics.
+ *
+ * @param stats Pointer to store counters
+ */
+void audio_agc_get_stats(audio_stats_t *stats);
+
+#endif /* AUDIO_AGC_H */
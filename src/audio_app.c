@@ -6,21 +6,44 @@
 #include <zephyr/kernel.h>
 #include <zephyr/device.h>
 #include <zephyr/drivers/i2s.h>
-#include <arm_math.h>
 #include <zephyr/logging/log.h>
+#include <math.h>
+#include <stdlib.h>
 #include "audio_app.h"
+#include "audio_dsp.h"
+#include "audio_adpcm.h"
+#include "audio_tone.h"
+#ifdef CONFIG_AUDIO_MFCC
+#include "audio_mfcc.h"
+#endif
+#ifdef CONFIG_AUDIO_AGC
+#include "audio_agc.h"
+#include "tlv320adc3100.h"
+#endif
+#ifdef CONFIG_AUDIO_ZOOM
+#include "audio_zoom.h"
+#endif
+#include "alarm_app.h"
+#include "measurement_pool.h"
+#include "flash_fs.h"
 #include "rtc_app.h"
 
 LOG_MODULE_REGISTER(audio_app, CONFIG_APP_LOG_LEVEL);
 
-/* Audio buffers */
-static int16_t audio_buffer[AUDIO_FRAME_SIZE];
-static float32_t fft_buffer[AUDIO_FFT_SIZE * 2];
-static float32_t window_buffer[AUDIO_FFT_SIZE];
-static arm_cfft_instance_f32 fft_instance;
+/* I2S receive block ring, filled by DMA and processed in place */
+#define AUDIO_BLOCK_SIZE (AUDIO_FRAME_SIZE * sizeof(int16_t))
+K_MEM_SLAB_DEFINE_STATIC(audio_slab, AUDIO_BLOCK_SIZE, CONFIG_AUDIO_BLOCK_COUNT, 4);
 
-/* FFT band configuration */
-static const fft_band_config_t fft_bands[FFT_BAND_COUNT] = {
+/* Filled block handed from the reader thread to the work queue */
+struct audio_block {
+    void *data;
+    size_t size;
+    bool gap;    /* Samples were lost before this block */
+};
+K_MSGQ_DEFINE(audio_block_msgq, sizeof(struct audio_block), CONFIG_AUDIO_BLOCK_COUNT, 4);
+
+/* Default FFT band configuration */
+static const fft_band_config_t default_bands[FFT_BAND_COUNT] = {
     {100, 200},    /* 100-200 Hz */
     {200, 300},    /* 200-300 Hz */
     {300, 400},    /* 300-400 Hz */
@@ -39,117 +62,665 @@ static const fft_band_config_t fft_bands[FFT_BAND_COUNT] = {
     {2500, 3000}   /* 2500-3000 Hz */
 };
 
+/* Default tones, queen piping and tooting harmonics */
+static const audio_tone_config_t default_tones = {
+    .count = 4,
+    .min_share = 30,
+    .min_level = 3000,
+    .persist_ms = 1000,
+    .freq = {350, 400, 450, 500},
+};
+
+/* Capture modes */
+typedef enum {
+    AUDIO_MODE_SPECTRUM,  /* Welch band levels */
+    AUDIO_MODE_RECORD,    /* Raw ADPCM recording to flash */
+    AUDIO_MODE_TONE,      /* Goertzel tone detection */
+    AUDIO_MODE_PRETRIGGER, /* No measurement, only the pre-trigger ring */
+} audio_mode_t;
+
 /* Audio state */
 static struct {
     const struct device *i2s_dev;
     measurement_callback_t callback;
     audio_config_t config;
     bool busy;
+    bool stopping;
+    bool streaming;      /* I2S is running, also between measurements for the pre-trigger ring */
     uint32_t samples_collected;
+    uint32_t timestamp;
     struct k_work_delayable stop_work;
+    audio_stats_t stats;
+    audio_mode_t mode;
+    audio_tone_config_t tones;
+#ifdef CONFIG_AUDIO_ACTIVITY_GATE
+    bool escalated;
+#endif
+#ifdef CONFIG_AUDIO_AGC
+    bool agc_skipped;    /* Blocks were skipped for a volume change since the last analysed one */
+#endif
 } audio_state;
 
+#ifdef CONFIG_AUDIO_ACTIVITY_GATE
+/* Floor rises by 1/256 of the excess per block, about 16 s to follow a step */
+#define ACTIVITY_FLOOR_RISE   256
+
+/* Sound-activity detector, thresholds adapt across recordings */
+static struct {
+    bool primed;
+    int32_t floor;      /* Background level in 1/AUDIO_LEVEL_SCALE dB */
+    uint8_t hangover;   /* Blocks still analysed after the last active one */
+    bool skipped;       /* A block was gated since the last analysed one */
+} activity;
+#endif
+
+/* Raw ADPCM recording streamed to flash */
+static struct {
+    struct fs_file_t file;
+    uint32_t index;
+    uint32_t samples;    /* Samples stored in complete blocks */
+    bool failed;         /* A write failed, later blocks are discarded */
+    audio_adpcm_t enc;
+} audio_rec;
+
+#ifdef CONFIG_AUDIO_PRETRIGGER
+/* ADPCM blocks holding CONFIG_AUDIO_PRETRIGGER_SECONDS of audio */
+#define PRETRIGGER_BLOCKS DIV_ROUND_UP(CONFIG_AUDIO_PRETRIGGER_SECONDS * AUDIO_SAMPLE_RATE, \
+                                       AUDIO_ADPCM_BLOCK_SAMPLES)
+
+/* Pre-trigger ring states */
+enum {
+    PRETRIGGER_RUNNING,  /* Blocks are added */
+    PRETRIGGER_PENDING,  /* Save requested, frozen by the audio work queue */
+    PRETRIGGER_FROZEN,   /* Being written to flash */
+};
+
+/* Always-on ADPCM ring of the most recent audio, saved on alarms */
+static struct {
+    bool enabled;
+    atomic_t state;
+    uint16_t head;          /* Next block to overwrite */
+    uint16_t count;         /* Complete blocks in the ring */
+    uint16_t last_samples;  /* Samples of the newest block when frozen */
+    audio_adpcm_t enc;
+    MEASUREMENT_RESULT_s trigger;
+    uint32_t blocks;        /* I2S blocks encoded */
+    uint64_t cycles;
+    uint32_t saves;
+    uint8_t ring[PRETRIGGER_BLOCKS][AUDIO_ADPCM_BLOCK_SIZE];
+} pretrigger;
+
+static struct k_work pretrigger_freeze_work;
+static struct k_work pretrigger_save_work;
+#endif
+
+/* Fraction bits of the noise floor, which moves by less than a level step */
+#define NOISE_FLOOR_FRAC 8
+
+BUILD_ASSERT(AUDIO_RESULT_EDGES(AUDIO_MAX_BANDS) + 2 * AUDIO_MAX_BANDS <= MAX_FFT_SIZE,
+             "Band edges do not fit the FFT result");
+
+/* Slow per-band background level across recordings */
+static struct {
+    int32_t level[AUDIO_MAX_BANDS];  /* 1/AUDIO_LEVEL_SCALE dB << NOISE_FLOOR_FRAC */
+    uint32_t recordings;             /* Recordings averaged, 0 after a layout change */
+} noise_floor;
+
 /* Work queue for audio processing */
 K_THREAD_STACK_DEFINE(audio_stack, 4096);
 static struct k_work_q audio_work_q;
 static struct k_work process_work;
+static struct k_work finish_work;
+#ifdef CONFIG_AUDIO_AGC
+/* Volume set by audio_app_config(), applied between blocks on the work queue */
+static atomic_t agc_volume;
+static struct k_work agc_volume_work;
+#endif
+
+/* I2S reader thread */
+K_THREAD_STACK_DEFINE(audio_rx_stack, 1024);
+static struct k_thread audio_rx_thread_data;
+static K_SEM_DEFINE(audio_rx_sem, 0, 1);
 
 /* Helper functions */
-static void apply_window(float32_t *data, size_t size)
+#ifdef CONFIG_AUDIO_ACTIVITY_GATE
+/* Check a block for sound activity from its RMS level and zero-crossing rate */
+static bool activity_detect(const int16_t *samples, size_t count)
 {
-    /* Apply Hanning window */
-    for (size_t i = 0; i < size; i++) {
-        data[i] *= window_buffer[i];
+    int64_t energy = 0;
+    uint32_t crossings = 0;
+    int32_t level;
+    int32_t zcr;
+    bool active;
+
+    for (size_t i = 0; i < count; i++) {
+        energy += (int32_t)samples[i] * samples[i];
+        if (i > 0 && (samples[i] < 0) != (samples[i - 1] < 0)) {
+            crossings++;
+        }
+    }
+
+    level = (int32_t)(10.0f * AUDIO_LEVEL_SCALE * log10f((float)energy / count + 1.0f));
+    zcr = crossings * 1000 / (count - 1);
+
+    if (!activity.primed) {
+        activity.floor = level;
+        activity.primed = true;
+    }
+
+    /* Louder than the background, without the high crossing rate of wind or rain */
+    active = level > activity.floor + CONFIG_AUDIO_ACTIVITY_MARGIN_DB * AUDIO_LEVEL_SCALE &&
+             zcr <= CONFIG_AUDIO_ACTIVITY_ZCR_MAX;
+
+    /* The floor drops at once and rises slowly, so it tracks the background */
+    if (level < activity.floor) {
+        activity.floor = level;
+    } else {
+        activity.floor += DIV_ROUND_UP(level - activity.floor, ACTIVITY_FLOOR_RISE);
+    }
+
+    if (active) {
+        activity.hangover = CONFIG_AUDIO_ACTIVITY_HANGOVER;
+        return true;
+    }
+
+    if (activity.hangover > 0) {
+        activity.hangover--;
+        return true;
     }
+
+    return false;
 }
+#endif
 
-static void calculate_band_magnitudes(const float32_t *fft_data, uint16_t *band_magnitudes)
+/* Store the completed ADPCM block holding a number of samples */
+static void record_store_block(uint16_t samples)
 {
-    float32_t magnitude;
-    uint16_t bin_freq;
-    
-    /* Calculate magnitude for each frequency band */
-    for (int band = 0; band < FFT_BAND_COUNT; band++) {
-        float32_t band_sum = 0;
-        int bin_count = 0;
-
-        /* Sum magnitudes for bins in this band */
-        for (int bin = 1; bin < AUDIO_FFT_SIZE/2; bin++) {
-            bin_freq = (bin * AUDIO_SAMPLE_RATE) / AUDIO_FFT_SIZE;
-            
-            if (bin_freq >= fft_bands[band].start_freq && 
-                bin_freq <= fft_bands[band].end_freq) {
-                /* Calculate magnitude from real and imaginary parts */
-                magnitude = sqrtf(fft_data[2*bin] * fft_data[2*bin] + 
-                                fft_data[2*bin+1] * fft_data[2*bin+1]);
-                band_sum += magnitude;
-                bin_count++;
+    int ret = flash_fs_audio_write(&audio_rec.file, audio_rec.enc.block,
+                                   AUDIO_ADPCM_BLOCK_SIZE);
+
+    if (ret < 0) {
+        LOG_ERR("Audio recording write failed: %d", ret);
+        audio_state.stats.rec_write_errors++;
+        audio_rec.failed = true;
+        /* Keep the samples written so far */
+        audio_app_start(false, INTERNAL_SOURCE);
+        return;
+    }
+
+    audio_rec.samples += samples;
+    audio_state.stats.rec_bytes += AUDIO_ADPCM_BLOCK_SIZE;
+}
+
+/* Encode a block into page sized ADPCM blocks written straight to flash */
+static void record_audio_block(const int16_t *samples, size_t count)
+{
+    while (count > 0 && !audio_rec.failed) {
+        size_t used = audio_adpcm_encode(&audio_rec.enc, samples, count);
+
+        samples += used;
+        count -= used;
+        if (audio_rec.enc.fill == AUDIO_ADPCM_BLOCK_SAMPLES) {
+            record_store_block(AUDIO_ADPCM_BLOCK_SAMPLES);
+        }
+    }
+}
+
+/* Store the partial last block and fill in the WAV header */
+static void record_finish(void)
+{
+    uint8_t header[AUDIO_ADPCM_WAV_HEADER_SIZE];
+    uint16_t fill = audio_rec.enc.fill;
+    int ret;
+
+    if (!audio_rec.failed && audio_adpcm_flush(&audio_rec.enc)) {
+        record_store_block(fill);
+    }
+
+    audio_adpcm_wav_header(header, AUDIO_SAMPLE_RATE, audio_rec.samples,
+                           audio_state.stats.rec_bytes);
+    ret = flash_fs_audio_finish(&audio_rec.file, header, sizeof(header));
+    if (ret < 0) {
+        LOG_ERR("Failed to finish audio recording: %d", ret);
+        audio_state.stats.rec_write_errors++;
+    }
+
+    LOG_INF("Audio recording %u: %u samples, %u bytes", audio_rec.index,
+            audio_rec.samples, audio_state.stats.rec_bytes + AUDIO_ADPCM_WAV_HEADER_SIZE);
+}
+
+#ifdef CONFIG_AUDIO_PRETRIGGER
+/* Start an empty ring */
+static void pretrigger_reset(void)
+{
+    audio_adpcm_init(&pretrigger.enc);
+    pretrigger.head = 0;
+    pretrigger.count = 0;
+}
+
+/* Move the encoder block into the ring, overwriting the oldest */
+static void pretrigger_store_block(void)
+{
+    memcpy(pretrigger.ring[pretrigger.head], pretrigger.enc.block, AUDIO_ADPCM_BLOCK_SIZE);
+    pretrigger.head = (pretrigger.head + 1) % PRETRIGGER_BLOCKS;
+    pretrigger.count = MIN(pretrigger.count + 1, PRETRIGGER_BLOCKS);
+}
+
+/* Encode every captured block into the ring unless it is frozen */
+static void pretrigger_feed(const int16_t *samples, size_t count)
+{
+    uint32_t start = k_cycle_get_32();
+
+    if (atomic_get(&pretrigger.state) == PRETRIGGER_FROZEN) {
+        return;
+    }
+
+    while (count > 0) {
+        size_t used = audio_adpcm_encode(&pretrigger.enc, samples, count);
+
+        samples += used;
+        count -= used;
+        if (pretrigger.enc.fill == AUDIO_ADPCM_BLOCK_SAMPLES) {
+            pretrigger_store_block();
+        }
+    }
+
+    pretrigger.blocks++;
+    pretrigger.cycles += k_cycle_get_32() - start;
+}
+
+/* Runs on the audio work queue, so no block is added while freezing */
+static void pretrigger_freeze_handler(struct k_work *work)
+{
+    uint16_t fill = pretrigger.enc.fill;
+
+    /* Keep the samples of the block in progress */
+    if (audio_adpcm_flush(&pretrigger.enc)) {
+        pretrigger_store_block();
+        pretrigger.last_samples = fill;
+    } else {
+        pretrigger.last_samples = AUDIO_ADPCM_BLOCK_SAMPLES;
+    }
+
+    atomic_set(&pretrigger.state, PRETRIGGER_FROZEN);
+    k_work_submit(&pretrigger_save_work);
+}
+
+/* Write the frozen ring as a WAV file, oldest block first */
+static void pretrigger_save_handler(struct k_work *work)
+{
+    uint8_t header[AUDIO_ADPCM_WAV_HEADER_SIZE];
+    struct fs_file_t file;
+    uint32_t index;
+    uint32_t samples = 0;
+    uint32_t size = 0;
+    uint16_t block = (pretrigger.head + PRETRIGGER_BLOCKS - pretrigger.count) % PRETRIGGER_BLOCKS;
+    int ret;
+
+    ret = flash_fs_audio_rotate(CONFIG_AUDIO_PRETRIGGER_MAX_FILES);
+    if (ret == 0) {
+        ret = flash_fs_audio_create(&file, &index);
+    }
+    if (ret < 0) {
+        goto done;
+    }
+
+    /* Placeholder header, sizes are known once the blocks are written */
+    audio_adpcm_wav_header(header, AUDIO_SAMPLE_RATE, 0, 0);
+    ret = flash_fs_audio_write(&file, header, sizeof(header));
+
+    for (int i = 0; i < pretrigger.count && ret == 0; i++) {
+        ret = flash_fs_audio_write(&file, pretrigger.ring[block], AUDIO_ADPCM_BLOCK_SIZE);
+        samples += (i == pretrigger.count - 1) ? pretrigger.last_samples :
+                                                 AUDIO_ADPCM_BLOCK_SAMPLES;
+        size += AUDIO_ADPCM_BLOCK_SIZE;
+        block = (block + 1) % PRETRIGGER_BLOCKS;
+    }
+
+    audio_adpcm_wav_header(header, AUDIO_SAMPLE_RATE, samples, size);
+    if (flash_fs_audio_finish(&file, header, sizeof(header)) < 0 && ret == 0) {
+        ret = -EIO;
+    }
+    if (ret == 0) {
+        ret = flash_fs_store_audio_trigger(index, &pretrigger.trigger);
+    }
+
+    if (ret == 0) {
+        pretrigger.saves++;
+        LOG_INF("Pre-trigger audio %u: %u samples before type %d measurement",
+                index, samples, pretrigger.trigger.type);
+    }
+
+done:
+    if (ret < 0) {
+        LOG_ERR("Failed to save pre-trigger audio: %d", ret);
+    }
+
+    /* Start over, the frozen time left a gap */
+    pretrigger_reset();
+    atomic_set(&pretrigger.state, PRETRIGGER_RUNNING);
+}
+#endif /* CONFIG_AUDIO_PRETRIGGER */
+
+#ifdef CONFIG_AUDIO_AGC
+/* Codec volume in dB of a gain setting, within the ADC digital volume range */
+static int8_t gain_to_volume(uint8_t gain)
+{
+    return (int8_t)CLAMP(gain - AUDIO_GAIN_0DB, TLV320ADC3100_VOLUME_MIN_DB,
+                         TLV320ADC3100_VOLUME_MAX_DB);
+}
+
+/* The loop state and codec writes belong to the audio work queue */
+static void agc_volume_handler(struct k_work *work)
+{
+    audio_agc_set_volume((int8_t)atomic_get(&agc_volume));
+}
+#endif
+
+/* Raise ALARM_AUDIO for a persistent tone, the result is too large for the work queue stack */
+static void raise_tone_alarm(int index)
+{
+    MEASUREMENT_RESULT_s *result;
+    FFT_RESULT_s *fft;
+
+    result = measurement_pool_alloc(AUDIO_ADC);
+    if (!result) {
+        LOG_WRN("No free measurement buffer, tone alarm dropped");
+        return;
+    }
+
+    fft = &result->result.fft;
+    memset(fft, 0, sizeof(*fft));
+    fft->frequency = audio_state.tones.freq[index];
+    fft->size = audio_tone_get_levels(fft->magnitude);
+    LOG_INF("Tone %u Hz persisted, %u.%02u dB", audio_state.tones.freq[index],
+            fft->magnitude[index] / AUDIO_LEVEL_SCALE,
+            fft->magnitude[index] % AUDIO_LEVEL_SCALE);
+
+    /* Alarm callbacks copy what they keep */
+    alarm_app_raise(ALARM_AUDIO, result);
+    measurement_pool_free(result);
+}
+
+static void process_audio_block(const int16_t *samples, size_t count, bool gap)
+{
+    uint32_t block_ms = count * 1000 / AUDIO_SAMPLE_RATE;
+
+#ifdef CONFIG_AUDIO_AGC
+    bool settled = audio_agc_process(samples, count, audio_state.config.agc_enabled);
+#endif
+#ifdef CONFIG_AUDIO_PRETRIGGER
+    pretrigger_feed(samples, count);
+#endif
+    if (audio_state.mode == AUDIO_MODE_PRETRIGGER) {
+        return;
+    }
+
+    audio_state.samples_collected += count;
+    audio_state.stats.blocks++;
+
+    if (audio_state.mode == AUDIO_MODE_RECORD) {
+        record_audio_block(samples, count);
+        return;
+    }
+
+    if (audio_state.mode == AUDIO_MODE_TONE) {
+        uint32_t raised = audio_tone_process(samples, count, gap);
+
+        for (int i = 0; raised; i++, raised >>= 1) {
+            if (raised & 1) {
+                raise_tone_alarm(i);
             }
         }
+        return;
+    }
 
-        /* Store average magnitude for this band */
-        if (bin_count > 0) {
-            band_magnitudes[band] = (uint16_t)(band_sum / bin_count);
-        } else {
-            band_magnitudes[band] = 0;
+#ifdef CONFIG_AUDIO_ACTIVITY_GATE
+    if (!activity_detect(samples, count)) {
+        /* Quiet block, skip the spectrum and start new segments after it */
+        activity.skipped = true;
+        audio_state.stats.gated_ms += block_ms;
+        return;
+    }
+
+    if (!audio_state.escalated && !audio_state.stopping) {
+        /* Activity in the listening window, record the full duration */
+        audio_state.escalated = true;
+        k_work_reschedule(&audio_state.stop_work, K_SECONDS(audio_state.config.duration));
+        LOG_INF("Sound activity, recording %u s", audio_state.config.duration);
+    }
+
+    gap |= activity.skipped;
+    activity.skipped = false;
+#endif
+
+#ifdef CONFIG_AUDIO_AGC
+    if (!settled) {
+        /* Captured around a volume change, start new segments after it */
+        audio_state.agc_skipped = true;
+        audio_state.stats.agc_skipped_ms += block_ms;
+        return;
+    }
+
+    gap |= audio_state.agc_skipped;
+    audio_state.agc_skipped = false;
+    int8_t gain_offset = audio_agc_get_volume() - gain_to_volume(audio_state.config.gain);
+
+    audio_dsp_set_gain_offset(gain_offset);
+#ifdef CONFIG_AUDIO_ZOOM
+    audio_zoom_set_gain_offset(gain_offset);
+#endif
+#endif
+
+    audio_dsp_process(samples, count, gap);
+#ifdef CONFIG_AUDIO_ZOOM
+    audio_zoom_process(samples, count, gap);
+#endif
+    audio_state.stats.analyzed_ms += block_ms;
+}
+
+/* Config byte FFT size code, log2(fft_size) - 8 */
+static uint8_t fft_size_code(uint16_t fft_size)
+{
+    return (uint8_t)(__builtin_ctz(fft_size) - 8);
+}
+
+/*
+ * Band level above the noise floor, then move the floor by
+ * 1/2^CONFIG_AUDIO_NOISE_FLOOR_SHIFT of the difference. The first
+ * recording after a layout change sets the floor.
+ */
+static void noise_floor_update(const uint16_t *levels, uint16_t *snr, int band_count)
+{
+    for (int band = 0; band < band_count; band++) {
+        int32_t level = (int32_t)levels[band] << NOISE_FLOOR_FRAC;
+        int32_t *floor = &noise_floor.level[band];
+
+        if (noise_floor.recordings == 0) {
+            *floor = level;
         }
+
+        int32_t diff = level - *floor;
+
+        snr[band] = (uint16_t)(int16_t)CLAMP(diff / (1 << NOISE_FLOOR_FRAC), INT16_MIN, INT16_MAX);
+        *floor += diff / (1 << CONFIG_AUDIO_NOISE_FLOOR_SHIFT);
     }
+
+    noise_floor.recordings++;
 }
 
-static void process_audio_data(void)
+/* Hand a pool result to the callback, which owns it from there */
+static void emit_result(MEASUREMENT_RESULT_s *result)
 {
-    fft_result_t fft_result;
-    struct tm time;
+    if (audio_state.callback) {
+        audio_state.callback(result);
+    } else {
+        measurement_pool_free(result);
+    }
+}
 
-    /* Convert samples to float and apply window */
-    for (int i = 0; i < AUDIO_FFT_SIZE; i++) {
-        fft_buffer[2*i] = (float32_t)audio_buffer[i] / 32768.0f;
-        fft_buffer[2*i+1] = 0.0f;
+/* Emit the Welch band levels and their variance for the whole recording */
+static void process_audio_result(void)
+{
+    MEASUREMENT_RESULT_s *result;
+    FFT_RESULT_s *fft;
+    int band_count;
+
+    result = measurement_pool_alloc(AUDIO_ADC);
+    if (!result) {
+        LOG_WRN("No free measurement buffer, audio result dropped");
+        return;
+    }
+
+    /* Levels and variances are written once, straight into the result */
+    fft = &result->result.fft;
+    band_count = audio_dsp_get_levels(fft->magnitude,
+                                      &fft->magnitude[audio_state.config.band_count]);
+    if (band_count < 0) {
+        measurement_pool_free(result);
+        if (audio_state.stats.gated_ms > 0 && audio_state.stats.analyzed_ms == 0) {
+            LOG_INF("No sound activity, analysis gated");
+        } else {
+            LOG_WRN("No audio frames captured");
+        }
+        return;
     }
-    apply_window(fft_buffer, AUDIO_FFT_SIZE);
+    __ASSERT_NO_MSG(band_count == audio_state.config.band_count);
 
-    /* Perform FFT */
-    arm_cfft_f32(&fft_instance, fft_buffer, 0, 1);
+    fft->size = audio_state.config.fft_size;
+    fft->frequency = AUDIO_FFT_SAMPLE_RATE;
+    fft->timestamp = audio_state.timestamp;
+    fft->band_count = band_count;
+    fft->encoding = audio_state.config.encoding;
 
-    /* Get current time for timestamp */
-    rtc_app_get_time(&time);
-    fft_result.timestamp = rtc_app_tm_to_timestamp(&time);
-    
     /* Set configuration byte */
-    fft_result.config = (audio_state.config.gain & 0xF0) | 
-                       ((audio_state.config.agc_enabled & 0x01) << 3) |
-                       (AUDIO_FFT_SIZE >> 10); /* Log2 of FFT size / 1024 */
+    fft->config = (audio_state.config.gain & 0xF0) |
+                  ((audio_state.config.agc_enabled & 0x01) << 3) |
+                  fft_size_code(audio_state.config.fft_size);
 
-    /* Calculate band magnitudes */
-    calculate_band_magnitudes(fft_buffer, fft_result.bands);
+    noise_floor_update(fft->magnitude, &fft->magnitude[2 * band_count], band_count);
+#ifdef CONFIG_AUDIO_AGC
+    audio_agc_get_stats(&audio_state.stats);
+    fft->magnitude[3 * band_count] = (uint16_t)audio_state.stats.agc_volume_mean;
+#endif
+    memcpy(&fft->magnitude[AUDIO_RESULT_EDGES(band_count)], audio_state.config.bands,
+           band_count * sizeof(fft_band_config_t));
 
-    /* Prepare LoRaWAN payload */
-    uint8_t payload[LORAWAN_MAX_PAYLOAD];
-    uint8_t payload_size;
-    
-    if (audio_app_encode_fft(&fft_result, payload, &payload_size) == 0) {
-        /* Create measurement result */
-        MEASUREMENT_RESULT_s result = {
-            .type = AUDIO_ADC,
-            .source = INTERNAL_SOURCE,
-            .result.fft = {
-                .size = AUDIO_FFT_SIZE,
-                .frequency = AUDIO_SAMPLE_RATE
-            }
-        };
-        memcpy(result.result.fft.magnitude, fft_result.bands, 
-               sizeof(fft_result.bands));
+    /* The payload is encoded by the transport */
+    emit_result(result);
 
-        /* Send to callback */
-        if (audio_state.callback) {
-            audio_state.callback(&result);
+#ifdef CONFIG_AUDIO_FEATURES
+    /* Summary features from the same spectrum */
+    result = measurement_pool_alloc(AUDIO_FEATURES);
+    if (result && audio_dsp_get_features(&result->result.features,
+                                         CONFIG_AUDIO_FEATURE_SPLIT_HZ) == 0) {
+        emit_result(result);
+    } else {
+        measurement_pool_free(result);
+    }
+#endif
+#ifdef CONFIG_AUDIO_MFCC
+    /* Mean cepstrum of the same segments */
+    result = measurement_pool_alloc(AUDIO_MFCC);
+    if (result) {
+        int count = audio_mfcc_get(result->result.mfcc.coeff);
+
+        if (count > 0) {
+            result->result.mfcc.count = count;
+            emit_result(result);
+        } else {
+            measurement_pool_free(result);
         }
     }
+#endif
+#ifdef CONFIG_AUDIO_ZOOM
+    /* Fine resolution spectrum around the zoom centre */
+    result = measurement_pool_alloc(AUDIO_ZOOM);
+    if (result && audio_zoom_get(&result->result.zoom) > 0) {
+        emit_result(result);
+    } else {
+        measurement_pool_free(result);
+    }
+#endif
+}
+
+/* Bytes of the audio work queue stack never touched since boot */
+static void update_stack_stats(audio_stats_t *stats)
+{
+#if defined(CONFIG_THREAD_STACK_INFO) && defined(CONFIG_INIT_STACKS)
+    size_t unused;
+
+    if (k_thread_stack_space_get(&audio_work_q.thread, &unused) == 0) {
+        stats->stack_unused = unused;
+    }
+#else
+    ARG_UNUSED(stats);
+#endif
 }
 
 static void audio_process_handler(struct k_work *work)
 {
-    process_audio_data();
+    struct audio_block block;
+
+    /* Blocks are processed in place and returned to the slab */
+    while (k_msgq_get(&audio_block_msgq, &block, K_NO_WAIT) == 0) {
+        process_audio_block(block.data, block.size / sizeof(int16_t), block.gap);
+        k_mem_slab_free(&audio_slab, &block.data);
+    }
+}
+
+static void audio_finish_handler(struct k_work *work)
+{
+    /* Process blocks still queued when capture stopped */
+    audio_process_handler(work);
+    if (!audio_state.busy) {
+        /* Pre-trigger stream stopped between measurements */
+        audio_state.mode = AUDIO_MODE_SPECTRUM;
+        return;
+    }
+
+    if (audio_state.mode == AUDIO_MODE_RECORD) {
+        record_finish();
+    } else if (audio_state.mode == AUDIO_MODE_TONE) {
+        audio_tone_get_stats(&audio_state.stats);
+        LOG_INF("Tone detection: %u windows, %u cycles per window",
+                audio_state.stats.tone_windows, audio_state.stats.tone_cycles_avg);
+    } else {
+        process_audio_result();
+    }
+#ifdef CONFIG_AUDIO_PRETRIGGER
+    audio_state.mode = pretrigger.enabled ? AUDIO_MODE_PRETRIGGER : AUDIO_MODE_SPECTRUM;
+#else
+    audio_state.mode = AUDIO_MODE_SPECTRUM;
+#endif
+
+    audio_dsp_get_stats(&audio_state.stats);
+    LOG_INF("Audio done: %u blocks, %u frames, %u dropped, %u overruns",
+            audio_state.stats.blocks, audio_state.stats.frames,
+            audio_state.stats.dropped_blocks, audio_state.stats.overruns);
+    LOG_INF("Audio time: %u ms analyzed, %u ms gated",
+            audio_state.stats.analyzed_ms, audio_state.stats.gated_ms);
+#ifdef CONFIG_AUDIO_AGC
+    audio_agc_get_stats(&audio_state.stats);
+    LOG_INF("AGC: %u changes, %u clipped blocks, %u ms settling, mean volume %d.%02u dB",
+            audio_state.stats.agc_changes, audio_state.stats.agc_clipped_blocks,
+            audio_state.stats.agc_skipped_ms, audio_state.stats.agc_volume_mean / AUDIO_LEVEL_SCALE,
+            abs(audio_state.stats.agc_volume_mean) % AUDIO_LEVEL_SCALE);
+#endif
+#ifdef CONFIG_AUDIO_ZOOM
+    audio_zoom_get_stats(&audio_state.stats);
+    LOG_INF("Zoom: %u segments, %u cycles per block",
+            audio_state.stats.zoom_frames, audio_state.stats.zoom_cycles_avg);
+#endif
+#if defined(CONFIG_THREAD_STACK_INFO) && defined(CONFIG_INIT_STACKS)
+    update_stack_stats(&audio_state.stats);
+    LOG_INF("Audio stack: %u of %u bytes unused", audio_state.stats.stack_unused,
+            (uint32_t)K_THREAD_STACK_SIZEOF(audio_stack));
+#endif
+    audio_dsp_report();
+
+    audio_state.stopping = false;
+    audio_state.busy = false;
 }
 
 static void audio_stop_handler(struct k_work *work)
@@ -157,6 +728,51 @@ static void audio_stop_handler(struct k_work *work)
     audio_app_start(false, INTERNAL_SOURCE);
 }
 
+/* Read filled I2S blocks and queue them for processing without copying */
+static void audio_rx_thread(void *p1, void *p2, void *p3)
+{
+    struct audio_block block;
+    int ret;
+
+    while (1) {
+        k_sem_take(&audio_rx_sem, K_FOREVER);
+        block.gap = false;
+
+        while (1) {
+            ret = i2s_read(audio_state.i2s_dev, &block.data, &block.size);
+            if (ret < 0) {
+                if (!audio_state.streaming) {
+                    /* Stopped and drained */
+                    break;
+                }
+
+                /* Overrun: the driver ran out of blocks, restart the stream */
+                audio_state.stats.overruns++;
+                block.gap = true;
+                i2s_trigger(audio_state.i2s_dev, I2S_DIR_RX, I2S_TRIGGER_DROP);
+                i2s_trigger(audio_state.i2s_dev, I2S_DIR_RX, I2S_TRIGGER_PREPARE);
+                if (i2s_trigger(audio_state.i2s_dev, I2S_DIR_RX, I2S_TRIGGER_START) < 0) {
+                    LOG_ERR("Failed to restart I2S after overrun");
+                    break;
+                }
+                continue;
+            }
+
+            if (k_msgq_put(&audio_block_msgq, &block, K_NO_WAIT) < 0) {
+                k_mem_slab_free(&audio_slab, &block.data);
+                audio_state.stats.dropped_blocks++;
+                block.gap = true;
+                continue;
+            }
+
+            block.gap = false;
+            k_work_submit_to_queue(&audio_work_q, &process_work);
+        }
+
+        k_work_submit_to_queue(&audio_work_q, &finish_work);
+    }
+}
+
 /* API Implementation */
 int audio_app_init(measurement_callback_t callback)
 {
@@ -168,15 +784,22 @@ int audio_app_init(measurement_callback_t callback)
 
     /* Initialize work items */
     k_work_init(&process_work, audio_process_handler);
+    k_work_init(&finish_work, audio_finish_handler);
+#ifdef CONFIG_AUDIO_AGC
+    k_work_init(&agc_volume_work, agc_volume_handler);
+#endif
     k_work_init_delayable(&audio_state.stop_work, audio_stop_handler);
+#ifdef CONFIG_AUDIO_PRETRIGGER
+    k_work_init(&pretrigger_freeze_work, pretrigger_freeze_handler);
+    k_work_init(&pretrigger_save_work, pretrigger_save_handler);
+#endif
 
-    /* Initialize FFT */
-    arm_cfft_init_f32(&fft_instance, AUDIO_FFT_SIZE);
-
-    /* Create Hanning window */
-    for (int i = 0; i < AUDIO_FFT_SIZE; i++) {
-        window_buffer[i] = 0.5f * (1.0f - cosf(2.0f * PI * i / (AUDIO_FFT_SIZE - 1)));
-    }
+    /* Start I2S reader */
+    k_thread_create(&audio_rx_thread_data, audio_rx_stack,
+                    K_THREAD_STACK_SIZEOF(audio_rx_stack),
+                    audio_rx_thread, NULL, NULL, NULL,
+                    K_PRIO_PREEMPT(9), 0, K_NO_WAIT);
+    k_thread_name_set(&audio_rx_thread_data, "audio_rx");
 
     /* Store callback */
     audio_state.callback = callback;
@@ -193,75 +816,100 @@ int audio_app_init(measurement_callback_t callback)
     audio_state.config.interval = 3600;
     audio_state.config.gain = 128;
     audio_state.config.agc_enabled = true;
+    audio_state.config.fft_size = AUDIO_FFT_SIZE;
+    audio_state.config.encoding = AUDIO_ENCODING_U16;
+    memcpy(audio_state.config.bands, default_bands, sizeof(default_bands));
 
-    return 0;
-}
-
-int audio_app_encode_fft(const fft_result_t *result, uint8_t *payload, uint8_t *size)
-{
-    if (!result || !payload || !size) {
-        return -EINVAL;
+    /* Keep the default bands the decimation filter passes without aliasing */
+    audio_state.config.band_count = 0;
+    while (audio_state.config.band_count < FFT_BAND_COUNT &&
+           default_bands[audio_state.config.band_count].end_freq <= AUDIO_FFT_SAMPLE_RATE * 2 / 5) {
+        audio_state.config.band_count++;
     }
 
-    /* Check maximum payload size */
-    if (FFT_HEADER_SIZE + (FFT_BAND_COUNT * FFT_BYTES_PER_BAND) > LORAWAN_MAX_PAYLOAD) {
-        return -ENOSPC;
+    audio_state.tones = default_tones;
+    audio_tone_setup(&audio_state.tones);
+
+#ifdef CONFIG_AUDIO_AGC
+    if (audio_agc_init(gain_to_volume(audio_state.config.gain)) < 0) {
+        LOG_WRN("Codec not ready, gain control disabled");
     }
+#endif
 
-    /* Encode header */
-    payload[0] = (result->timestamp >> 24) & 0xFF;
-    payload[1] = (result->timestamp >> 16) & 0xFF;
-    payload[2] = (result->timestamp >> 8) & 0xFF;
-    payload[3] = result->timestamp & 0xFF;
-    payload[4] = result->config;
+    /* Precompute window and bin map for the default layout */
+    int ret = audio_dsp_setup(audio_state.config.fft_size, audio_state.config.bands,
+                              audio_state.config.band_count);
+    if (ret < 0) {
+        return ret;
+    }
 
-    /* Encode band magnitudes */
-    for (int i = 0; i < FFT_BAND_COUNT; i++) {
-        payload[FFT_HEADER_SIZE + (i * 2)] = (result->bands[i] >> 8) & 0xFF;
-        payload[FFT_HEADER_SIZE + (i * 2) + 1] = result->bands[i] & 0xFF;
+#ifdef CONFIG_AUDIO_ZOOM
+    ret = audio_zoom_setup(CONFIG_AUDIO_ZOOM_CENTER_HZ);
+    if (ret < 0) {
+        LOG_ERR("Zoom window around %d Hz does not fit", CONFIG_AUDIO_ZOOM_CENTER_HZ);
+        return ret;
     }
+#endif
 
-    *size = FFT_HEADER_SIZE + (FFT_BAND_COUNT * FFT_BYTES_PER_BAND);
-    return 0;
+#ifdef CONFIG_AUDIO_PRETRIGGER
+    LOG_INF("Pre-trigger ring: %u s, %zu bytes", CONFIG_AUDIO_PRETRIGGER_SECONDS,
+            sizeof(pretrigger.ring));
+    ret = audio_app_pretrigger(true);
+#endif
+    return ret;
 }
 
-int audio_app_decode_fft(const uint8_t *payload, uint8_t size, fft_result_t *result)
+int audio_app_config(const audio_config_t *config)
 {
-    if (!payload || !result || size < FFT_HEADER_SIZE) {
+    if (!config) {
         return -EINVAL;
     }
 
-    /* Decode header */
-    result->timestamp = ((uint32_t)payload[0] << 24) |
-                       ((uint32_t)payload[1] << 16) |
-                       ((uint32_t)payload[2] << 8) |
-                       payload[3];
-    result->config = payload[4];
+    /* Validate configuration */
+    if (config->duration > AUDIO_MAX_DURATION) {
+        return -EINVAL;
+    }
 
-    /* Decode band magnitudes */
-    int band_count = (size - FFT_HEADER_SIZE) / FFT_BYTES_PER_BAND;
-    if (band_count > FFT_BAND_COUNT) {
-        band_count = FFT_BAND_COUNT;
+    if (config->encoding > AUDIO_ENCODING_DELTA4 ||
+        audio_app_encoded_size(config->encoding, config->band_count) == 0) {
+        return -EINVAL;
     }
 
-    for (int i = 0; i < band_count; i++) {
-        result->bands[i] = ((uint16_t)payload[FFT_HEADER_SIZE + (i * 2)] << 8) |
-                          payload[FFT_HEADER_SIZE + (i * 2) + 1];
+    if (audio_state.busy) {
+        return -EBUSY;
     }
 
-    return 0;
-}
+    /* Recompute window and bin map only when the layout changes */
+    if (config->fft_size != audio_state.config.fft_size ||
+        config->band_count != audio_state.config.band_count ||
+        memcmp(config->bands, audio_state.config.bands,
+               config->band_count * sizeof(fft_band_config_t)) != 0) {
+        /* Rejected layouts leave the current one untouched */
+        int ret = audio_dsp_setup(config->fft_size, config->bands, config->band_count);
 
-int audio_app_config(const audio_config_t *config)
-{
-    if (!config) {
-        return -EINVAL;
+        if (ret < 0) {
+            return ret;
+        }
+        /* Levels of other bands are no baseline */
+        noise_floor.recordings = 0;
     }
 
-    /* Validate configuration */
-    if (config->duration > AUDIO_MAX_DURATION) {
-        return -EINVAL;
+    /* Levels follow the configured gain, restart the baseline with it */
+    if (config->gain != audio_state.config.gain) {
+        noise_floor.recordings = 0;
+    }
+
+#ifdef CONFIG_AUDIO_AGC
+    /*
+     * A new gain or AGC mode restarts from the configured volume. The
+     * pre-trigger stream may be running the loop, so change it there.
+     */
+    if (config->gain != audio_state.config.gain ||
+        config->agc_enabled != audio_state.config.agc_enabled) {
+        atomic_set(&agc_volume, gain_to_volume(config->gain));
+        k_work_submit_to_queue(&audio_work_q, &agc_volume_work);
     }
+#endif
 
     memcpy(&audio_state.config, config, sizeof(audio_config_t));
     return 0;
@@ -282,45 +930,273 @@ bool audio_app_busy(void)
     return audio_state.busy;
 }
 
-int audio_app_start(bool start, MEASUREMENT_SOURCE_e source)
+int audio_app_get_stats(audio_stats_t *stats)
 {
-    if (start && !audio_state.busy) {
-        /* Configure I2S */
-        struct i2s_config i2s_cfg = {
-            .word_size = AUDIO_BITS_PER_SAMPLE,
-            .channels = 1,
-            .format = I2S_FMT_DATA_FORMAT_I2S,
-            .options = I2S_OPT_BIT_CLK_MASTER | I2S_OPT_FRAME_CLK_MASTER,
-            .frame_clk_freq = AUDIO_SAMPLE_RATE,
-            .mem_slab = NULL,
-            .block_size = AUDIO_FRAME_SIZE * sizeof(int16_t),
-            .timeout = K_MSEC(200)
-        };
-        
-        int ret = i2s_configure(audio_state.i2s_dev, I2S_DIR_RX, &i2s_cfg);
-        if (ret < 0) {
-            return ret;
-        }
+    if (!stats) {
+        return -EINVAL;
+    }
+
+    memcpy(stats, &audio_state.stats, sizeof(audio_stats_t));
+    audio_dsp_get_stats(stats);
+    audio_tone_get_stats(stats);
+#ifdef CONFIG_AUDIO_PRETRIGGER
+    stats->pretrig_ram = sizeof(pretrigger.ring);
+    stats->pretrig_cycles_avg = pretrigger.blocks ? pretrigger.cycles / pretrigger.blocks : 0;
+    stats->pretrig_saves = pretrigger.saves;
+#endif
+#ifdef CONFIG_AUDIO_AGC
+    audio_agc_get_stats(stats);
+#endif
+#ifdef CONFIG_AUDIO_ZOOM
+    audio_zoom_get_stats(stats);
+#endif
+    update_stack_stats(stats);
+    return 0;
+}
+
+/* Start the I2S stream, blocks are processed in the current mode */
+static int stream_start(void)
+{
+    /* Configure I2S */
+    struct i2s_config i2s_cfg = {
+        .word_size = AUDIO_BITS_PER_SAMPLE,
+        .channels = 1,
+        .format = I2S_FMT_DATA_FORMAT_I2S,
+        .options = I2S_OPT_BIT_CLK_MASTER | I2S_OPT_FRAME_CLK_MASTER,
+        .frame_clk_freq = AUDIO_SAMPLE_RATE,
+        .mem_slab = &audio_slab,
+        .block_size = AUDIO_BLOCK_SIZE,
+        .timeout = 200
+    };
+    
+    int ret = i2s_configure(audio_state.i2s_dev, I2S_DIR_RX, &i2s_cfg);
+    if (ret < 0) {
+        return ret;
+    }
+
+    /* Start I2S */
+    ret = i2s_trigger(audio_state.i2s_dev, I2S_DIR_RX, I2S_TRIGGER_START);
+    if (ret < 0) {
+        return ret;
+    }
+
+    audio_state.streaming = true;
+    k_sem_give(&audio_rx_sem);
+    return 0;
+}
+
+/* Stop the I2S stream, the reader drains the remaining blocks and finishes */
+static void stream_stop(void)
+{
+    audio_state.streaming = false;
+    i2s_trigger(audio_state.i2s_dev, I2S_DIR_RX, I2S_TRIGGER_STOP);
+}
+
+/* Start a measurement in a mode, stopped after a timeout */
+static int capture_start(audio_mode_t mode, k_timeout_t stop_after)
+{
+    struct tm time;
+
+    /* Reset accumulation for the new recording */
+    audio_dsp_reset();
+#ifdef CONFIG_AUDIO_ZOOM
+    audio_zoom_reset();
+#endif
+    memset(&audio_state.stats, 0, sizeof(audio_state.stats));
+    audio_state.samples_collected = 0;
+#ifdef CONFIG_AUDIO_ACTIVITY_GATE
+    audio_state.escalated = false;
+    activity.hangover = 0;
+    activity.skipped = false;
+#endif
+#ifdef CONFIG_AUDIO_AGC
+    audio_agc_reset();
+    audio_state.agc_skipped = false;
+#endif
+    rtc_app_get_time(&time);
+    audio_state.timestamp = rtc_app_tm_to_timestamp(&time);
+
+    audio_state.busy = true;
+    audio_state.stopping = false;
+
+    /* Mode last, a running pre-trigger stream only feeds the ring until then */
+    audio_state.mode = mode;
+
+    if (!audio_state.streaming) {
+        int ret = stream_start();
 
-        /* Start I2S */
-        ret = i2s_trigger(audio_state.i2s_dev, I2S_DIR_RX, I2S_TRIGGER_START);
         if (ret < 0) {
+            audio_state.mode = AUDIO_MODE_SPECTRUM;
+            audio_state.busy = false;
             return ret;
         }
+    }
 
-        audio_state.busy = true;
-        audio_state.samples_collected = 0;
+    if (!K_TIMEOUT_EQ(stop_after, K_FOREVER)) {
+        k_work_schedule(&audio_state.stop_work, stop_after);
+    }
+    return 0;
+}
 
+int audio_app_start(bool start, MEASUREMENT_SOURCE_e source)
+{
+    if (start && !audio_state.busy) {
+#ifdef CONFIG_AUDIO_ACTIVITY_GATE
+        /* Listen first, activity extends to the configured duration */
+        return capture_start(AUDIO_MODE_SPECTRUM,
+                             K_MSEC(MIN(CONFIG_AUDIO_ACTIVITY_LISTEN_MS,
+                                        audio_state.config.duration * MSEC_PER_SEC)));
+#else
         /* Schedule stop after configured duration */
-        k_work_schedule(&audio_state.stop_work, 
-                       K_SECONDS(audio_state.config.duration));
-
-    } else if (!start && audio_state.busy) {
-        /* Stop I2S */
-        i2s_trigger(audio_state.i2s_dev, I2S_DIR_RX, I2S_TRIGGER_STOP);
-        audio_state.busy = false;
+        return capture_start(AUDIO_MODE_SPECTRUM, K_SECONDS(audio_state.config.duration));
+#endif
+    } else if (!start && audio_state.busy && !audio_state.stopping) {
+        audio_state.stopping = true;
         k_work_cancel_delayable(&audio_state.stop_work);
+#ifdef CONFIG_AUDIO_PRETRIGGER
+        if (pretrigger.enabled) {
+            /* Keep streaming into the ring, finish behind the queued blocks */
+            k_work_submit_to_queue(&audio_work_q, &finish_work);
+            return 0;
+        }
+#endif
+        stream_stop();
+    }
+
+    return 0;
+}
+
+int audio_app_record(uint32_t duration, uint32_t *index)
+{
+    uint8_t header[AUDIO_ADPCM_WAV_HEADER_SIZE];
+    int ret;
+
+    if (!index || duration == 0 || duration > AUDIO_MAX_DURATION) {
+        return -EINVAL;
+    }
+
+    if (audio_state.busy) {
+        return -EBUSY;
+    }
+
+    ret = flash_fs_audio_create(&audio_rec.file, &audio_rec.index);
+    if (ret < 0) {
+        return ret;
+    }
+
+    /* Placeholder header, sizes are filled in when the recording ends */
+    audio_adpcm_wav_header(header, AUDIO_SAMPLE_RATE, 0, 0);
+    ret = flash_fs_audio_write(&audio_rec.file, header, sizeof(header));
+    if (ret < 0) {
+        flash_fs_audio_finish(&audio_rec.file, header, sizeof(header));
+        return ret;
+    }
+
+    audio_adpcm_init(&audio_rec.enc);
+    audio_rec.samples = 0;
+    audio_rec.failed = false;
+
+    ret = capture_start(AUDIO_MODE_RECORD, K_SECONDS(duration));
+    if (ret < 0) {
+        flash_fs_audio_finish(&audio_rec.file, header, sizeof(header));
+        return ret;
+    }
+
+    *index = audio_rec.index;
+    return 0;
+}
+
+int audio_app_tone_detect(uint32_t duration)
+{
+    if (audio_state.busy) {
+        return -EBUSY;
+    }
+
+    audio_tone_reset();
+    return capture_start(AUDIO_MODE_TONE, duration ? K_SECONDS(duration) : K_FOREVER);
+}
+
+#ifdef CONFIG_AUDIO_PRETRIGGER
+int audio_app_pretrigger(bool enable)
+{
+    int ret;
+
+    if (audio_state.busy) {
+        return -EBUSY;
+    }
+
+    if (enable == pretrigger.enabled) {
+        return 0;
+    }
+
+    if (!enable) {
+        pretrigger.enabled = false;
+        stream_stop();
+        return 0;
+    }
+
+    pretrigger_reset();
+    atomic_set(&pretrigger.state, PRETRIGGER_RUNNING);
+    audio_state.mode = AUDIO_MODE_PRETRIGGER;
+
+    ret = stream_start();
+    if (ret < 0) {
+        audio_state.mode = AUDIO_MODE_SPECTRUM;
+        return ret;
+    }
+
+    pretrigger.enabled = true;
+    return 0;
+}
+
+int audio_app_pretrigger_save(const MEASUREMENT_RESULT_s *trigger)
+{
+    if (!trigger) {
+        return -EINVAL;
+    }
+
+    if (!pretrigger.enabled) {
+        return -ENODATA;
+    }
+
+    /* One save at a time, later alarms fall in the frozen time */
+    if (!atomic_cas(&pretrigger.state, PRETRIGGER_RUNNING, PRETRIGGER_PENDING)) {
+        return -EBUSY;
+    }
+
+    pretrigger.trigger = *trigger;
+    k_work_submit_to_queue(&audio_work_q, &pretrigger_freeze_work);
+    return 0;
+}
+#endif /* CONFIG_AUDIO_PRETRIGGER */
+
+int audio_app_tone_config(const audio_tone_config_t *config)
+{
+    int ret;
+
+    if (!config) {
+        return -EINVAL;
+    }
+
+    if (audio_state.busy) {
+        return -EBUSY;
+    }
+
+    ret = audio_tone_setup(config);
+    if (ret < 0) {
+        return ret;
+    }
+
+    audio_state.tones = *config;
+    return 0;
+}
+
+int audio_app_get_tone_config(audio_tone_config_t *config)
+{
+    if (!config) {
+        return -EINVAL;
     }
 
+    *config = audio_state.tones;
     return 0;
 }
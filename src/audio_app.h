@@ -14,13 +14,39 @@
 #define AUDIO_BITS_PER_SAMPLE 16     /* 16-bit */
 #define AUDIO_MAX_DURATION    300    /* 5 minutes in seconds */
 #define AUDIO_FRAME_SIZE      1024   /* Samples per frame */
-#define AUDIO_FFT_SIZE        512    /* FFT size (power of 2) */
+#define AUDIO_FFT_SIZE        512    /* Default FFT size (power of 2) */
+#define AUDIO_FFT_SIZE_MIN    256    /* Smallest configurable FFT size */
+#define AUDIO_FFT_SIZE_MAX    2048   /* Largest configurable FFT size */
+#define AUDIO_FFT_SAMPLE_RATE (AUDIO_SAMPLE_RATE / CONFIG_AUDIO_DECIMATION) /* Rate after decimation */
 
 /* FFT frequency bands for LoRaWAN payload */
-#define FFT_BAND_COUNT        16     /* Number of frequency bands */
-#define FFT_BYTES_PER_BAND    2      /* Bytes per band magnitude */
-#define FFT_HEADER_SIZE       4      /* Timestamp and config bytes */
+#define FFT_BAND_COUNT        16     /* Default number of frequency bands */
+#define AUDIO_MAX_BANDS       48     /* Maximum configurable number of bands */
+#define AUDIO_RESULT_EDGES(n) (3 * (n) + 1) /* Band edges in fft.magnitude of n bands */
+#define FFT_BYTES_PER_BAND    2      /* Bytes per band in AUDIO_ENCODING_U16 */
+#define FFT_HEADER_SIZE       6      /* Timestamp, config and format bytes */
 #define LORAWAN_MAX_PAYLOAD   51     /* Maximum LoRaWAN payload size */
+#define FFT_MAX_PAYLOAD       (LORAWAN_MAX_PAYLOAD - 1) /* Less the measurement type byte */
+
+/* Zoom spectrum uplink */
+#define ZOOM_HEADER_SIZE      5      /* Centre, resolution and bin count bytes */
+#define ZOOM_UPLINK_BINS      43     /* Middle bins in DB8 within FFT_MAX_PAYLOAD, odd */
+
+/* Goertzel tone detection */
+#define AUDIO_MAX_TONES       8      /* Maximum number of detected tones */
+#define AUDIO_TONE_WINDOW     256    /* Samples per tone window, 16 ms and 62.5 Hz resolution */
+
+/* Band levels are dB relative to one int16 LSB */
+#define AUDIO_LSB_DB          90.309f /* 20 * log10(32768) */
+#define AUDIO_LEVEL_SCALE     100    /* Result units per dB (0.01 dB) */
+#define AUDIO_MFCC_SCALE      100    /* Result units per cepstral coefficient */
+
+/* Gain setting of 0 dB codec volume, gain is the volume in dB plus this */
+#define AUDIO_GAIN_0DB        127
+
+/* Quantisation steps of the compact encodings, in result units */
+#define AUDIO_DB8_STEP        50     /* 0.5 dB */
+#define AUDIO_DELTA4_STEP     200    /* 2 dB */
 
 /* FFT band configuration */
 typedef struct {
@@ -28,24 +54,83 @@ typedef struct {
     uint16_t end_freq;    /* Band end frequency in Hz */
 } fft_band_config_t;
 
+/* Goertzel tone detection configuration */
+typedef struct {
+    uint8_t count;                   /* Number of entries used in freq */
+    uint8_t min_share;               /* Minimum share of the window energy in percent */
+    uint16_t min_level;              /* Minimum tone level in 1/AUDIO_LEVEL_SCALE dB */
+    uint16_t persist_ms;             /* Time a tone must persist before the alarm */
+    uint16_t freq[AUDIO_MAX_TONES];  /* Tone frequencies in Hz */
+} audio_tone_config_t;
+
+/*
+ * Band encodings of the FFT payload. The payload starts with timestamp
+ * (4, big endian), config byte, and a format byte holding the encoding
+ * in bits 6-7 and the band count in bits 0-5, followed by:
+ *
+ * U16:    2 bytes per band, big endian level. Up to 22 bands, exact.
+ * DB8:    1 byte reference level in whole dB (loudest band rounded up),
+ *         then 1 byte per band counting AUDIO_DB8_STEP below it. Up to
+ *         43 bands, within 0.25 dB for bands down to 126.5 dB below the
+ *         loudest band.
+ * DELTA4: first band as 2 byte level, then a signed 4-bit step count of
+ *         AUDIO_DELTA4_STEP per following band, high nibble first. Up to
+ *         48 bands, within 1 dB while adjacent bands differ by at most
+ *         +14/-16 dB, steeper edges are caught up over the next bands.
+ */
+typedef enum {
+    AUDIO_ENCODING_U16 = 0,
+    AUDIO_ENCODING_DB8 = 1,
+    AUDIO_ENCODING_DELTA4 = 2,
+} audio_encoding_t;
+
 /* Audio configuration */
 typedef struct {
     uint32_t duration;    /* Recording duration in seconds */
     uint16_t interval;    /* Time between recordings in seconds */
-    uint8_t gain;        /* Input gain (0-255) */
+    uint8_t gain;        /* Codec volume + AUDIO_GAIN_0DB in dB (115-147), level reference and AGC start */
     bool agc_enabled;    /* Automatic gain control */
+    uint16_t fft_size;   /* FFT size, power of 2 from AUDIO_FFT_SIZE_MIN to AUDIO_FFT_SIZE_MAX */
+    uint8_t band_count;  /* Number of entries used in bands */
+    fft_band_config_t bands[AUDIO_MAX_BANDS]; /* Band edges */
+    uint8_t encoding;    /* audio_encoding_t of the uplink payload */
 } audio_config_t;
 
-/* FFT result for LoRaWAN */
+/* Capture statistics for the current or last recording */
 typedef struct {
-    uint32_t timestamp;  /* Recording timestamp */
-    uint8_t config;      /* Configuration byte */
-    uint16_t bands[FFT_BAND_COUNT]; /* Band magnitudes */
-} fft_result_t;
+    uint32_t blocks;           /* I2S blocks processed */
+    uint32_t frames;           /* FFT frames accumulated */
+    uint32_t dropped_blocks;   /* Blocks dropped because the processing queue was full */
+    uint32_t overruns;         /* I2S overruns, the driver ran out of free blocks */
+    uint32_t frame_cycles_avg; /* Average CPU cycles per FFT frame */
+    uint32_t frame_cycles_max; /* Worst case CPU cycles per FFT frame */
+    uint32_t band_cycles_avg;  /* Average CPU cycles of the band reduction per frame */
+    uint32_t decim_cycles_avg; /* Average CPU cycles of the decimation filter per I2S block */
+    uint32_t analyzed_ms;      /* Audio passed to spectrum analysis */
+    uint32_t gated_ms;         /* Audio skipped by the activity detector */
+    uint32_t rec_bytes;        /* ADPCM data written by audio_app_record() */
+    uint32_t rec_write_errors; /* Failed flash writes, a failure ends the recording */
+    uint32_t tone_windows;     /* Goertzel windows evaluated */
+    uint32_t tone_cycles_avg;  /* Average CPU cycles per Goertzel window */
+    uint32_t pretrig_ram;      /* RAM of the pre-trigger ADPCM ring in bytes */
+    uint32_t pretrig_cycles_avg; /* Average CPU cycles of the ring encoder per I2S block */
+    uint32_t pretrig_saves;    /* Pre-trigger rings written to flash since boot */
+    uint32_t agc_changes;      /* Codec volume changes by the AGC */
+    uint32_t agc_clipped_blocks; /* Blocks with a peak above CONFIG_AUDIO_AGC_PEAK_DBFS */
+    uint32_t agc_skipped_ms;   /* Audio not analysed while a volume change settled */
+    int32_t agc_volume_mean;   /* Mean applied codec volume in 1/AUDIO_LEVEL_SCALE dB */
+    uint32_t zoom_frames;      /* Zoom FFT segments accumulated */
+    uint32_t zoom_cycles_avg;  /* Average CPU cycles of the zoom spectrum per I2S block */
+    uint32_t stack_unused;     /* Audio work queue stack never used, with CONFIG_THREAD_STACK_INFO */
+} audio_stats_t;
 
 /**
  * @brief Initialize audio subsystem
  *
+ * Results are written into measurement pool buffers and passed to the
+ * callback by reference. The callback owns the buffer and releases it
+ * with measurement_pool_free() or queues it with measurement_pool_put().
+ *
  * @param callback Measurement callback function
  * @return 0 on success, negative errno code on failure
  */
@@ -54,12 +139,123 @@ int audio_app_init(measurement_callback_t callback);
 /**
  * @brief Start or stop audio processing
  *
+ * Capture streams I2S blocks for the configured duration and emits one
+ * result with Welch-averaged band levels over the whole recording, using
+ * Hann segments with 50% overlap. In the AUDIO_ADC result, with N the
+ * configured band count, fft.magnitude[0..N-1] holds the mean level of
+ * each band and fft.magnitude[N..2N-1] the variance of the per-segment
+ * level, both in 1/AUDIO_LEVEL_SCALE dB (dB^2) units.
+ * fft.magnitude[2N..3N-1] holds each band level above its noise floor
+ * as a signed value in 1/AUDIO_LEVEL_SCALE dB. The floor is a slow
+ * exponential average of the band levels of earlier recordings, see
+ * CONFIG_AUDIO_NOISE_FLOOR_SHIFT, restarted when the band layout or
+ * gain changes.
+ *
+ * With CONFIG_AUDIO_AGC and agc_enabled, the codec volume follows the
+ * signal level. Levels are corrected to the configured gain, and
+ * fft.magnitude[3N] holds the mean applied volume as a signed value in
+ * 1/AUDIO_LEVEL_SCALE dB. Blocks captured while a volume change settles
+ * are not analysed.
+ *
+ * From fft.magnitude[AUDIO_RESULT_EDGES(N)] on, the result holds the
+ * start and end frequency in Hz of each band, so checks against it do
+ * not depend on the layout configured later.
+ *
+ * The result also carries the timestamp, configuration byte, band count
+ * and uplink encoding; the transport encodes the payload when sending.
+ *
+ * With CONFIG_AUDIO_ACTIVITY_GATE, capture first listens for
+ * CONFIG_AUDIO_ACTIVITY_LISTEN_MS and only records the configured
+ * duration once a block is active. Quiet blocks skip the spectrum, so
+ * the levels cover active audio only, and a recording without activity
+ * emits no result.
+ *
  * @param start true to start, false to stop
  * @param source Source of the request
  * @return 0 on success, negative errno code on failure
  */
 int audio_app_start(bool start, MEASUREMENT_SOURCE_e source);
 
+/**
+ * @brief Record raw audio to flash
+ *
+ * Streams I2S blocks through a 4:1 IMA-ADPCM encoder into a WAV file
+ * FLASH_FS_MOUNT_POINT "/audio/<index>.wav", one 256 byte ADPCM block
+ * at a time, instead of computing band levels. Lost I2S blocks are
+ * counted in the statistics and leave a discontinuity in the file.
+ *
+ * @param duration Recording duration in seconds
+ * @param index Pointer to store the recording index for flash_fs_read_audio()
+ * @return 0 on success, -EBUSY while capturing, negative errno code on failure
+ */
+int audio_app_record(uint32_t duration, uint32_t *index);
+
+/**
+ * @brief Run Goertzel tone detection
+ *
+ * Evaluates the configured tone frequencies on windows of
+ * AUDIO_TONE_WINDOW samples instead of computing band levels. A tone is
+ * present in a window when its level and its share of the window energy
+ * reach the thresholds. Once present windows outnumber absent ones for
+ * persist_ms, an ALARM_AUDIO alarm is raised with an AUDIO_ADC result
+ * holding the tone count in fft.size, the alarmed frequency in
+ * fft.frequency and the level of each tone in fft.magnitude. The tone
+ * alarms again only after its presence has decayed.
+ *
+ * @param duration Detection time in seconds, 0 to run until stopped
+ *                 with audio_app_start()
+ * @return 0 on success, -EBUSY while capturing, negative errno code on failure
+ */
+int audio_app_tone_detect(uint32_t duration);
+
+/**
+ * @brief Enable or disable the pre-trigger ring
+ *
+ * With CONFIG_AUDIO_PRETRIGGER, I2S keeps running between measurements
+ * and every captured block is encoded into a RAM ring holding the last
+ * CONFIG_AUDIO_PRETRIGGER_SECONDS as IMA-ADPCM. Enabled by
+ * audio_app_init(). Measurements start and stop without interrupting
+ * the stream.
+ *
+ * @param enable true to keep capturing into the ring, false to stop I2S
+ * @return 0 on success, -EBUSY while a measurement runs, negative errno
+ *         code on failure
+ */
+int audio_app_pretrigger(bool enable);
+
+/**
+ * @brief Save the pre-trigger ring
+ *
+ * Freezes the ring and writes it from the system work queue as the next
+ * FLASH_FS_MOUNT_POINT "/audio/<index>.wav", oldest audio first, with
+ * the triggering measurement in "/audio/<index>.trg", after rotating
+ * out the oldest recordings beyond CONFIG_AUDIO_PRETRIGGER_MAX_FILES.
+ * The ring restarts empty once written. Safe to call from any thread, including alarm
+ * callbacks.
+ *
+ * @param trigger Measurement that caused the save
+ * @return 0 on success, -ENODATA if the ring is disabled, -EBUSY while
+ *         a previous save is in progress, -EINVAL if trigger is NULL
+ */
+int audio_app_pretrigger_save(const MEASUREMENT_RESULT_s *trigger);
+
+/**
+ * @brief Configure tone detection
+ *
+ * @param config Tone frequencies and thresholds
+ * @return 0 on success, -EBUSY while capturing, -EINVAL for an invalid
+ *         configuration
+ */
+int audio_app_tone_config(const audio_tone_config_t *config);
+
+/**
+ * @brief Get current tone detection configuration
+ *
+ * @param config Pointer to store configuration
+ * @return 0 on success, negative errno code on failure
+ */
+int audio_app_get_tone_config(audio_tone_config_t *config);
+
 /**
  * @brief Check if audio processing is active
  *
@@ -67,11 +263,23 @@ int audio_app_start(bool start, MEASUREMENT_SOURCE_e source);
  */
 bool audio_app_busy(void);
 
+/**
+ * @brief Get capture statistics
+ *
+ * @param stats Pointer to store statistics
+ * @return 0 on success, negative errno code on failure
+ */
+int audio_app_get_stats(audio_stats_t *stats);
+
 /**
  * @brief Configure audio parameters
  *
+ * A changed FFT size or band layout recomputes the window and bin map.
+ *
  * @param config Audio configuration
- * @return 0 on success, negative errno code on failure
+ * @return 0 on success, -EBUSY while recording, -ENOMEM if the FFT size
+ *         does not fit CONFIG_AUDIO_DSP_SCRATCH_SIZE, other negative
+ *         errno code on failure
  */
 int audio_app_config(const audio_config_t *config);
 
@@ -83,24 +291,67 @@ int audio_app_config(const audio_config_t *config);
  */
 int audio_app_get_config(audio_config_t *config);
 
+/**
+ * @brief Get the payload size of an encoding
+ *
+ * @param encoding audio_encoding_t of the payload
+ * @param band_count Number of bands
+ * @return Payload size in bytes, 0 if the encoding is unknown or the
+ *         bands do not fit FFT_MAX_PAYLOAD
+ */
+uint8_t audio_app_encoded_size(audio_encoding_t encoding, uint8_t band_count);
+
 /**
  * @brief Encode FFT result for LoRaWAN transmission
  *
- * @param result FFT result to encode
- * @param payload Buffer to store encoded payload
+ * @param result FFT result to encode, the first band_count magnitudes
+ *               in the encoding it selects
+ * @param payload Buffer of FFT_MAX_PAYLOAD bytes to store encoded payload
  * @param size Pointer to store payload size
- * @return 0 on success, negative errno code on failure
+ * @return 0 on success, -ENOSPC if the bands do not fit the payload in
+ *         the selected encoding, other negative errno code on failure
  */
-int audio_app_encode_fft(const fft_result_t *result, uint8_t *payload, uint8_t *size);
+int audio_app_encode_fft(const FFT_RESULT_s *result, uint8_t *payload, uint8_t *size);
 
 /**
  * @brief Decode FFT payload from LoRaWAN
  *
+ * Reverses any audio_encoding_t, compact encodings decode to within
+ * the error bound documented for that encoding. The FFT size follows
+ * from the config byte, the sample rate is not part of the payload.
+ *
  * @param payload Received payload
  * @param size Payload size
  * @param result Pointer to store decoded result
  * @return 0 on success, negative errno code on failure
  */
-int audio_app_decode_fft(const uint8_t *payload, uint8_t size, fft_result_t *result);
+int audio_app_decode_fft(const uint8_t *payload, uint8_t size, FFT_RESULT_s *result);
+
+/**
+ * @brief Encode a zoom spectrum for LoRaWAN transmission
+ *
+ * The payload holds the centre in Hz (2, big endian), the bin spacing
+ * in mHz (2, big endian) and the bin count (1), followed by the bin
+ * levels in the DB8 encoding. Only the middle ZOOM_UPLINK_BINS bins are
+ * sent, the centre bin stays in the middle.
+ *
+ * @param zoom Zoom spectrum to encode
+ * @param payload Buffer of FFT_MAX_PAYLOAD bytes to store encoded payload
+ * @param size Pointer to store payload size
+ * @return 0 on success, negative errno code on failure
+ */
+int audio_app_encode_zoom(const AUDIO_ZOOM_s *zoom, uint8_t *payload, uint8_t *size);
+
+/**
+ * @brief Decode a zoom spectrum payload from LoRaWAN
+ *
+ * Levels decode to within the DB8 error bound.
+ *
+ * @param payload Received payload
+ * @param size Payload size
+ * @param zoom Pointer to store the decoded bins
+ * @return 0 on success, negative errno code on failure
+ */
+int audio_app_decode_zoom(const uint8_t *payload, uint8_t size, AUDIO_ZOOM_s *zoom);
 
 #endif /* AUDIO_APP_H */
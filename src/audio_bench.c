@@ -0,0 +1,705 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Audio DSP benchmark (CONFIG_AUDIO_BENCHMARK). Replaces the application:
+ * feeds synthetic hive signals and an optional WAV file through the DSP
+ * core at every FFT size that fits the scratch memory and logs the
+ * processing cost, memory use and band level error against a double
+ * precision reference of the same pipeline. Builds for native_posix_64
+ * and for the target boards, see docs/building.md.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/logging/log.h>
+#include "audio_app.h"
+#include "audio_dsp.h"
+#include "audio_adpcm.h"
+#ifdef CONFIG_AUDIO_ZOOM
+#include "audio_zoom.h"
+#endif
+#ifdef CONFIG_AUDIO_MFCC
+#include "audio_mfcc.h"
+#endif
+#ifdef CONFIG_ARCH_POSIX
+#include <time.h>
+#include <posix_board_if.h>
+#endif
+
+LOG_MODULE_REGISTER(audio_bench, CONFIG_APP_LOG_LEVEL);
+
+/* Samples per call of audio_dsp_process, as one I2S block of 32 ms */
+#define BENCH_BLOCK 512
+
+/* Bands of the benchmark layout, 100 Hz up to what the decimation filter passes */
+#define BENCH_BANDS     16
+#define BENCH_BAND_LOW  100
+#define BENCH_BAND_HIGH MIN(3000, AUDIO_FFT_SAMPLE_RATE * 2 / 5)
+
+#ifdef CONFIG_AUDIO_MFCC
+/*
+ * Largest coefficient difference of the MFCC check in 1/AUDIO_MFCC_SCALE
+ * units. The float32 pipeline is within 0.01 of the double reference
+ * on a host, the rest is margin for the polynomial log of arm_vlog_f32.
+ */
+#define BENCH_MFCC_TOLERANCE 5
+
+/* Coefficients of the check tone from scripts/mfcc_reference.py, see CMakeLists.txt */
+static const int16_t bench_mfcc_expected[] = {
+#include "audio_bench_mfcc.inc"
+};
+
+BUILD_ASSERT(ARRAY_SIZE(bench_mfcc_expected) == CONFIG_AUDIO_MFCC_COUNT,
+             "MFCC reference is out of date");
+#endif
+
+#ifdef AUDIO_BENCH_WAV
+/* 16-bit mono PCM WAV from CONFIG_AUDIO_BENCHMARK_WAV, embedded at build time */
+static const uint8_t bench_wav[] = {
+#include "audio_bench_wav.inc"
+};
+#endif
+
+typedef enum {
+    SIGNAL_HIVE,     /* Colony hum with harmonics and a piping queen */
+    SIGNAL_PINK,     /* Pink noise */
+#ifdef AUDIO_BENCH_WAV
+    SIGNAL_WAV,      /* Embedded recording */
+#endif
+    SIGNAL_COUNT,
+} bench_signal_t;
+
+static const char *const signal_names[SIGNAL_COUNT] = {
+    "hive",
+    "pink",
+#ifdef AUDIO_BENCH_WAV
+    "wav",
+#endif
+};
+
+/* Signal generator state */
+static struct {
+    bench_signal_t signal;
+    uint32_t position;   /* Samples produced */
+    uint32_t length;     /* Samples in the signal */
+    uint32_t rng;
+    float pink[7];       /* Paul Kellet's pink noise filter state */
+#ifdef AUDIO_BENCH_WAV
+    const uint8_t *wav_data;
+    uint32_t wav_samples;
+#endif
+} gen;
+
+/* Double precision model of the decimation, window, FFT and band averaging */
+static struct {
+    const int16_t *decim;
+    size_t taps;
+    int16_t history[128];  /* Input samples, newest at history[0] */
+    uint32_t phase;        /* Inputs since the last decimated output */
+
+    uint16_t fft_size;
+    uint16_t fill;
+    double frame[AUDIO_FFT_SIZE_MAX];
+    double window[AUDIO_FFT_SIZE_MAX];
+    struct {
+        uint16_t first;
+        uint16_t count;
+    } band_bins[BENCH_BANDS];
+    double band_sum[BENCH_BANDS];
+    uint32_t frames;
+} ref;
+
+static fft_band_config_t bench_bands[BENCH_BANDS];
+
+static float white_noise(void)
+{
+    /* xorshift32, uniform in [-1, 1) */
+    gen.rng ^= gen.rng << 13;
+    gen.rng ^= gen.rng >> 17;
+    gen.rng ^= gen.rng << 5;
+    return (int32_t)gen.rng / 2147483648.0f;
+}
+
+static int16_t pink_noise(void)
+{
+    float white = white_noise();
+    float *b = gen.pink;
+
+    b[0] = 0.99886f * b[0] + white * 0.0555179f;
+    b[1] = 0.99332f * b[1] + white * 0.0750759f;
+    b[2] = 0.96900f * b[2] + white * 0.1538520f;
+    b[3] = 0.86650f * b[3] + white * 0.3104856f;
+    b[4] = 0.55000f * b[4] + white * 0.5329522f;
+    b[5] = -0.7616f * b[5] - white * 0.0168980f;
+    float pink = b[0] + b[1] + b[2] + b[3] + b[4] + b[5] + b[6] + white * 0.5362f;
+
+    b[6] = white * 0.115926f;
+
+    /* Filter gain is about 3, scaled to roughly -26 dBFS RMS */
+    return (int16_t)CLAMP(lroundf(pink * 0.05f * 32768.0f / 3.0f), INT16_MIN, INT16_MAX);
+}
+
+static int16_t hive_sample(uint32_t n)
+{
+    const double t = (double)n / AUDIO_SAMPLE_RATE;
+    /* 230 Hz hum at -20 dBFS with two harmonics, 400 Hz piping 20 dB below */
+    double x = 0.1 * sin(2 * M_PI * 230 * t) +
+               0.05 * sin(2 * M_PI * 460 * t + 0.3) +
+               0.025 * sin(2 * M_PI * 690 * t + 1.1) +
+               0.01 * sin(2 * M_PI * 400 * t);
+
+    /* Noise floor about 70 dB below the hum */
+    x += 0.00003 * white_noise();
+    return (int16_t)lround(x * 32767.0);
+}
+
+#ifdef AUDIO_BENCH_WAV
+/* Locate the samples of the embedded WAV, 0 on success */
+static int wav_open(void)
+{
+    size_t offset = 12;
+
+    if (sizeof(bench_wav) < 12 || memcmp(bench_wav, "RIFF", 4) != 0 ||
+        memcmp(&bench_wav[8], "WAVE", 4) != 0) {
+        return -EINVAL;
+    }
+
+    gen.wav_data = NULL;
+    while (offset + 8 <= sizeof(bench_wav)) {
+        const uint8_t *chunk = &bench_wav[offset];
+        uint32_t size = sys_get_le32(&chunk[4]);
+
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            if (sys_get_le16(&chunk[8]) != 1 || sys_get_le16(&chunk[10]) != 1 ||
+                sys_get_le32(&chunk[12]) != AUDIO_SAMPLE_RATE ||
+                sys_get_le16(&chunk[22]) != 16) {
+                LOG_ERR("WAV must be 16-bit mono PCM at %d Hz", AUDIO_SAMPLE_RATE);
+                return -ENOTSUP;
+            }
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            gen.wav_data = &chunk[8];
+            gen.wav_samples = MIN(size, sizeof(bench_wav) - offset - 8) / 2;
+            return 0;
+        }
+        offset += 8 + ROUND_UP(size, 2);
+    }
+
+    return -EINVAL;
+}
+#endif
+
+static int signal_start(bench_signal_t signal)
+{
+    memset(&gen, 0, sizeof(gen));
+    gen.signal = signal;
+    gen.rng = 0x12345678;
+    gen.length = CONFIG_AUDIO_BENCHMARK_SECONDS * AUDIO_SAMPLE_RATE;
+
+#ifdef AUDIO_BENCH_WAV
+    if (signal == SIGNAL_WAV) {
+        int ret = wav_open();
+
+        if (ret < 0) {
+            return ret;
+        }
+        gen.length = gen.wav_samples;
+    }
+#endif
+    return 0;
+}
+
+/* Next block of the signal, returns the number of samples */
+static size_t signal_read(int16_t *samples, size_t count)
+{
+    count = MIN(count, gen.length - gen.position);
+    /* Keep whole decimator input groups */
+    count -= count % CONFIG_AUDIO_DECIMATION;
+
+    for (size_t i = 0; i < count; i++) {
+        uint32_t n = gen.position + i;
+
+        switch (gen.signal) {
+        case SIGNAL_HIVE:
+            samples[i] = hive_sample(n);
+            break;
+        case SIGNAL_PINK:
+            samples[i] = pink_noise();
+            break;
+#ifdef AUDIO_BENCH_WAV
+        case SIGNAL_WAV:
+            samples[i] = (int16_t)sys_get_le16(&gen.wav_data[2 * n]);
+            break;
+#endif
+        default:
+            samples[i] = 0;
+            break;
+        }
+    }
+
+    gen.position += count;
+    return count;
+}
+
+/* Same bin to band rule as the DSP core: truncated bin centre within the edges */
+static void ref_setup(uint16_t fft_size)
+{
+    memset(&ref, 0, sizeof(ref));
+    ref.decim = audio_dsp_decim_filter(&ref.taps);
+    __ASSERT_NO_MSG(ref.taps <= ARRAY_SIZE(ref.history));
+    ref.fft_size = fft_size;
+
+    for (int i = 0; i < fft_size; i++) {
+        ref.window[i] = 0.5 * (1.0 - cos(2.0 * M_PI * i / (fft_size - 1))) / 32768.0;
+    }
+
+    for (int band = 0; band < BENCH_BANDS; band++) {
+        for (int bin = 1; bin < fft_size / 2; bin++) {
+            uint16_t bin_freq = ((uint32_t)bin * AUDIO_FFT_SAMPLE_RATE) / fft_size;
+
+            if (bin_freq >= bench_bands[band].start_freq &&
+                bin_freq <= bench_bands[band].end_freq) {
+                if (ref.band_bins[band].count == 0) {
+                    ref.band_bins[band].first = bin;
+                }
+                ref.band_bins[band].count++;
+            }
+        }
+    }
+}
+
+/* Bin powers by Goertzel, exact DFT magnitudes without an FFT buffer */
+static void ref_segment(void)
+{
+    for (int band = 0; band < BENCH_BANDS; band++) {
+        double sum = 0;
+
+        for (int i = 0; i < ref.band_bins[band].count; i++) {
+            int bin = ref.band_bins[band].first + i;
+            double coeff = 2.0 * cos(2.0 * M_PI * bin / ref.fft_size);
+            double s1 = 0, s2 = 0;
+
+            for (int n = 0; n < ref.fft_size; n++) {
+                double s0 = ref.frame[n] * ref.window[n] + coeff * s1 - s2;
+
+                s2 = s1;
+                s1 = s0;
+            }
+            sum += s1 * s1 + s2 * s2 - coeff * s1 * s2;
+        }
+
+        if (ref.band_bins[band].count > 0) {
+            ref.band_sum[band] += sum / ref.band_bins[band].count;
+        }
+    }
+
+    ref.frames++;
+}
+
+static void ref_feed(double sample)
+{
+    const uint16_t hop = ref.fft_size / 2;
+
+    ref.frame[ref.fill++] = sample;
+    if (ref.fill == ref.fft_size) {
+        ref_segment();
+        memmove(ref.frame, &ref.frame[hop], (ref.fft_size - hop) * sizeof(double));
+        ref.fill = ref.fft_size - hop;
+    }
+}
+
+static void ref_process(const int16_t *samples, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        if (!ref.decim) {
+            ref_feed(samples[i]);
+            continue;
+        }
+
+        /* Unquantised FIR over the Q15 taps, one output per factor inputs */
+        memmove(&ref.history[1], ref.history, (ref.taps - 1) * sizeof(int16_t));
+        ref.history[0] = samples[i];
+        if (++ref.phase == CONFIG_AUDIO_DECIMATION) {
+            double acc = 0;
+
+            ref.phase = 0;
+            for (size_t k = 0; k < ref.taps; k++) {
+                acc += (double)ref.decim[k] * ref.history[k];
+            }
+            ref_feed(acc / 32768.0);
+        }
+    }
+}
+
+/* Reference band level in 1/AUDIO_LEVEL_SCALE dB, as audio_dsp_get_levels() */
+static int32_t ref_level(int band)
+{
+    double power = ref.band_sum[band] / MAX(ref.frames, 1);
+    double db = MAX(10.0 * log10(power + 1e-12) + AUDIO_LSB_DB, 0.0);
+
+    return (int32_t)(db * AUDIO_LEVEL_SCALE);
+}
+
+#ifdef CONFIG_ARCH_POSIX
+/* native_posix: the cycle counter follows simulated time, take the host clock */
+static uint64_t host_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+#endif
+
+/* Round trip every payload encoding of the measured levels */
+static void bench_encodings(const uint16_t *levels)
+{
+    static const char *const names[] = {"U16", "DB8", "DELTA4"};
+    static FFT_RESULT_s result;
+    static FFT_RESULT_s decoded;
+    uint8_t payload[FFT_MAX_PAYLOAD];
+    uint8_t size;
+
+    result.band_count = BENCH_BANDS;
+    memcpy(result.magnitude, levels, BENCH_BANDS * sizeof(uint16_t));
+
+    for (int encoding = AUDIO_ENCODING_U16; encoding <= AUDIO_ENCODING_DELTA4; encoding++) {
+        int32_t worst = 0;
+
+        result.encoding = encoding;
+        uint32_t start = k_cycle_get_32();
+        int ret = audio_app_encode_fft(&result, payload, &size);
+        uint32_t cycles = k_cycle_get_32() - start;
+
+        if (ret < 0 || audio_app_decode_fft(payload, size, &decoded) < 0) {
+            LOG_WRN("  %s: round trip failed", names[encoding]);
+            continue;
+        }
+
+        for (int band = 0; band < BENCH_BANDS; band++) {
+            worst = MAX(worst, abs((int32_t)decoded.magnitude[band] - levels[band]));
+        }
+        LOG_INF("  %s: %u bytes, %u cycles, max error %d.%02d dB", names[encoding],
+                size, cycles, worst / AUDIO_LEVEL_SCALE, worst % AUDIO_LEVEL_SCALE);
+    }
+}
+
+/* ADPCM encoder cost and signal to noise ratio of the decoded signal */
+static void bench_adpcm(bench_signal_t signal)
+{
+    static audio_adpcm_t enc;
+    static audio_adpcm_t track;
+    int16_t samples[BENCH_BLOCK];
+    uint64_t cycles = 0;
+    uint32_t blocks = 0;
+    double signal_energy = 0, noise_energy = 0;
+    size_t count;
+
+    if (signal_start(signal) < 0) {
+        return;
+    }
+    audio_adpcm_init(&enc);
+    audio_adpcm_init(&track);
+
+    while ((count = signal_read(samples, ARRAY_SIZE(samples))) > 0) {
+        size_t used = 0;
+
+        while (used < count) {
+            uint32_t start = k_cycle_get_32();
+
+            used += audio_adpcm_encode(&enc, &samples[used], count - used);
+            cycles += k_cycle_get_32() - start;
+            if (enc.fill == AUDIO_ADPCM_BLOCK_SAMPLES) {
+                blocks++;
+            }
+        }
+
+        /* The encoder predictor is the decoded sample, track it one sample at a time */
+        for (size_t i = 0; i < count; i++) {
+            double err;
+
+            audio_adpcm_encode(&track, &samples[i], 1);
+            err = (double)samples[i] - track.predictor;
+            signal_energy += (double)samples[i] * samples[i];
+            noise_energy += err * err;
+        }
+    }
+
+    int32_t snr = (int32_t)(10.0 * log10((signal_energy + 1.0) / (noise_energy + 1.0)));
+
+    LOG_INF("%s ADPCM: %u cycles per %d sample block, SNR %d dB", signal_names[signal],
+            blocks ? (uint32_t)(cycles / blocks) : 0, AUDIO_ADPCM_BLOCK_SAMPLES, snr);
+}
+
+#ifdef CONFIG_AUDIO_ZOOM
+/* Zoom spectrum cost and its strongest bin */
+static void bench_zoom(bench_signal_t signal)
+{
+    static AUDIO_ZOOM_s result;
+    int16_t samples[BENCH_BLOCK];
+    audio_stats_t stats;
+    size_t count;
+    int peak = 0;
+
+    if (audio_zoom_setup(CONFIG_AUDIO_ZOOM_CENTER_HZ) < 0 || signal_start(signal) < 0) {
+        return;
+    }
+
+    while ((count = signal_read(samples, ARRAY_SIZE(samples))) > 0) {
+        audio_zoom_process(samples, count - count % CONFIG_AUDIO_ZOOM_DECIMATION, false);
+    }
+
+    if (audio_zoom_get(&result) < 0) {
+        LOG_WRN("%s zoom: signal shorter than one segment", signal_names[signal]);
+        return;
+    }
+    audio_zoom_get_stats(&stats);
+
+    for (int bin = 1; bin < result.count; bin++) {
+        if (result.level[bin] > result.level[peak]) {
+            peak = bin;
+        }
+    }
+
+    int32_t peak_mhz = result.center_freq * 1000 + (peak - result.count / 2) * result.resolution;
+
+    LOG_INF("%s zoom: %u segments, %u cycles per %d sample block, peak %d.%03d Hz at %u.%02u dB",
+            signal_names[signal], stats.zoom_frames, stats.zoom_cycles_avg, BENCH_BLOCK,
+            peak_mhz / 1000, peak_mhz % 1000, result.level[peak] / AUDIO_LEVEL_SCALE,
+            result.level[peak] % AUDIO_LEVEL_SCALE);
+
+    /* Round trip of the middle bins sent in the uplink */
+    static AUDIO_ZOOM_s decoded;
+    uint8_t payload[FFT_MAX_PAYLOAD];
+    uint8_t size;
+    int32_t max_err = 0;
+
+    if (audio_app_encode_zoom(&result, payload, &size) < 0 ||
+        audio_app_decode_zoom(payload, size, &decoded) < 0) {
+        LOG_WRN("%s zoom: uplink encoding failed", signal_names[signal]);
+        return;
+    }
+
+    int first = (result.count - decoded.count) / 2;
+
+    for (int bin = 0; bin < decoded.count; bin++) {
+        max_err = MAX(max_err, abs((int32_t)decoded.level[bin] - result.level[first + bin]));
+    }
+
+    LOG_INF("%s zoom uplink: %u of %u bins in %u bytes, max error %d.%02d dB",
+            signal_names[signal], decoded.count, result.count, size,
+            max_err / AUDIO_LEVEL_SCALE, max_err % AUDIO_LEVEL_SCALE);
+}
+#endif
+
+#ifdef CONFIG_AUDIO_MFCC
+/* Cepstrum of a tone against the host reference, -EIO beyond the tolerance */
+static int bench_mfcc(void)
+{
+    int16_t samples[BENCH_BLOCK];
+    int16_t coeff[CONFIG_AUDIO_MFCC_COUNT];
+    const uint32_t length = AUDIO_BENCH_MFCC_SECONDS * AUDIO_SAMPLE_RATE;
+    int32_t worst = 0;
+    int worst_coeff = 0;
+    int ret;
+
+    if (CONFIG_AUDIO_DECIMATION > 1) {
+        /* The reference does not model the decimation filter */
+        LOG_INF("MFCC check skipped, needs CONFIG_AUDIO_DECIMATION_NONE");
+        return 0;
+    }
+
+    ret = audio_dsp_setup(AUDIO_BENCH_MFCC_FFT_SIZE, bench_bands, BENCH_BANDS);
+    if (ret < 0) {
+        return ret;
+    }
+
+    for (uint32_t position = 0; position < length; position += ARRAY_SIZE(samples)) {
+        size_t count = MIN(ARRAY_SIZE(samples), length - position);
+
+        /* Same samples as the tone of the reference script */
+        for (size_t i = 0; i < count; i++) {
+            double t = (double)(position + i) / AUDIO_SAMPLE_RATE;
+
+            samples[i] = (int16_t)lround(AUDIO_BENCH_MFCC_AMPLITUDE *
+                                         sin(2 * M_PI * AUDIO_BENCH_MFCC_TONE * t));
+        }
+        audio_dsp_process(samples, count, false);
+    }
+
+    ret = audio_mfcc_get(coeff);
+    if (ret < 0) {
+        return ret;
+    }
+
+    for (int k = 0; k < CONFIG_AUDIO_MFCC_COUNT; k++) {
+        int32_t err = abs((int32_t)coeff[k] - bench_mfcc_expected[k]);
+
+        LOG_DBG("  c%d: %d, reference %d", k, coeff[k], bench_mfcc_expected[k]);
+        if (err > worst) {
+            worst = err;
+            worst_coeff = k;
+        }
+    }
+
+    LOG_INF("MFCC %d Hz tone: max error %d.%02d in c%d, tolerance %d.%02d: %s",
+            AUDIO_BENCH_MFCC_TONE, worst / AUDIO_MFCC_SCALE, worst % AUDIO_MFCC_SCALE,
+            worst_coeff, BENCH_MFCC_TOLERANCE / AUDIO_MFCC_SCALE,
+            BENCH_MFCC_TOLERANCE % AUDIO_MFCC_SCALE,
+            worst <= BENCH_MFCC_TOLERANCE ? "pass" : "FAIL");
+
+    return (worst <= BENCH_MFCC_TOLERANCE) ? 0 : -EIO;
+}
+#endif
+
+/* One signal through the DSP core at one FFT size */
+static int bench_run(bench_signal_t signal, uint16_t fft_size)
+{
+    int16_t samples[BENCH_BLOCK];
+    uint16_t mean[BENCH_BANDS], var[BENCH_BANDS];
+    audio_stats_t stats;
+    uint64_t cycles = 0;
+    uint64_t ns = 0;
+    int64_t square_sum = 0;
+    int32_t worst = 0;
+    int worst_band = 0;
+    size_t count;
+    int ret;
+
+    ret = audio_dsp_setup(fft_size, bench_bands, BENCH_BANDS);
+    if (ret < 0) {
+        return ret;
+    }
+    ret = signal_start(signal);
+    if (ret < 0) {
+        return ret;
+    }
+    ref_setup(fft_size);
+
+    while ((count = signal_read(samples, ARRAY_SIZE(samples))) > 0) {
+#ifdef CONFIG_ARCH_POSIX
+        uint64_t start_ns = host_ns();
+#endif
+        uint32_t start = k_cycle_get_32();
+
+        audio_dsp_process(samples, count, false);
+        cycles += k_cycle_get_32() - start;
+#ifdef CONFIG_ARCH_POSIX
+        ns += host_ns() - start_ns;
+#endif
+
+        /* Reference is not timed */
+        ref_process(samples, count);
+    }
+
+#ifndef CONFIG_ARCH_POSIX
+    ns = k_cyc_to_ns_floor64(cycles);
+#endif
+
+    if (audio_dsp_get_levels(mean, var) < 0) {
+        LOG_WRN("%s FFT %u: signal shorter than one segment", signal_names[signal], fft_size);
+        return 0;
+    }
+    audio_dsp_get_stats(&stats);
+
+    for (int band = 0; band < BENCH_BANDS; band++) {
+        int32_t err = (int32_t)mean[band] - ref_level(band);
+
+        LOG_DBG("  band %u-%u Hz: %u, reference %d", bench_bands[band].start_freq,
+                bench_bands[band].end_freq, mean[band], ref_level(band));
+        square_sum += (int64_t)err * err;
+        if (abs(err) > worst) {
+            worst = abs(err);
+            worst_band = band;
+        }
+    }
+
+    int32_t rms = (int32_t)sqrt((double)square_sum / BENCH_BANDS);
+
+    LOG_INF("%s FFT %u: %u frames, %u cycles and %u ns per frame", signal_names[signal],
+            fft_size, stats.frames, (uint32_t)(cycles / stats.frames),
+            (uint32_t)(ns / stats.frames));
+    LOG_INF("  transform avg %u max %u, bands %u, decimation %u per block cycles",
+            stats.frame_cycles_avg, stats.frame_cycles_max, stats.band_cycles_avg,
+            stats.decim_cycles_avg);
+    LOG_INF("  level error: rms %d.%02d dB, max %d.%02d dB in %u-%u Hz (%u reference frames)",
+            rms / AUDIO_LEVEL_SCALE, rms % AUDIO_LEVEL_SCALE, worst / AUDIO_LEVEL_SCALE,
+            worst % AUDIO_LEVEL_SCALE, bench_bands[worst_band].start_freq,
+            bench_bands[worst_band].end_freq, ref.frames);
+    LOG_INF("  scratch %zu of %d bytes", audio_dsp_ram_required(fft_size),
+            CONFIG_AUDIO_DSP_SCRATCH_SIZE);
+    bench_encodings(mean);
+
+    return 0;
+}
+
+static int audio_bench_run(void)
+{
+    const uint16_t width = (BENCH_BAND_HIGH - BENCH_BAND_LOW) / BENCH_BANDS;
+    size_t unused;
+    int ret = 0;
+
+    for (int band = 0; band < BENCH_BANDS; band++) {
+        bench_bands[band].start_freq = BENCH_BAND_LOW + band * width;
+        bench_bands[band].end_freq = BENCH_BAND_LOW + (band + 1) * width;
+    }
+
+    LOG_INF("Audio benchmark: %s, decimation %d, %d bands %u-%u Hz",
+            IS_ENABLED(CONFIG_AUDIO_DSP_Q15) ? "Q15" : "float", CONFIG_AUDIO_DECIMATION,
+            BENCH_BANDS, bench_bands[0].start_freq, bench_bands[BENCH_BANDS - 1].end_freq);
+
+    for (bench_signal_t signal = 0; signal < SIGNAL_COUNT; signal++) {
+        for (uint16_t fft_size = AUDIO_FFT_SIZE_MIN; fft_size <= AUDIO_FFT_SIZE_MAX;
+             fft_size *= 2) {
+            if (audio_dsp_ram_required(fft_size) > CONFIG_AUDIO_DSP_SCRATCH_SIZE) {
+                break;
+            }
+
+            ret = bench_run(signal, fft_size);
+            if (ret < 0) {
+                LOG_ERR("%s FFT %u failed: %d", signal_names[signal], fft_size, ret);
+                break;
+            }
+        }
+        bench_adpcm(signal);
+#ifdef CONFIG_AUDIO_ZOOM
+        bench_zoom(signal);
+#endif
+    }
+
+#ifdef CONFIG_AUDIO_MFCC
+    int mfcc_ret = bench_mfcc();
+
+    if (mfcc_ret < 0) {
+        LOG_ERR("MFCC check failed: %d", mfcc_ret);
+        ret = mfcc_ret;
+    }
+#endif
+
+    /* Stack high-water of everything above, including the DSP core */
+    if (k_thread_stack_space_get(k_current_get(), &unused) == 0) {
+        size_t size = k_current_get()->stack_info.size;
+
+        LOG_INF("Stack used %zu of %zu bytes, reference model %zu bytes",
+                size - unused, size, sizeof(ref));
+    }
+
+    return ret;
+}
+
+int main(void)
+{
+    int ret = audio_bench_run();
+
+    LOG_INF("Audio benchmark done");
+#ifdef CONFIG_ARCH_POSIX
+    /* Let the log drain, then leave the simulator */
+    k_sleep(K_MSEC(100));
+    posix_exit(ret < 0 ? 1 : 0);
+#endif
+    return ret;
+}
@@ -0,0 +1,682 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <zephyr/kernel.h>
+#include <arm_math.h>
+#include <zephyr/logging/log.h>
+#include "audio_dsp.h"
+#ifdef CONFIG_AUDIO_MFCC
+#include "audio_mfcc.h"
+#endif
+
+LOG_MODULE_REGISTER(audio_dsp, CONFIG_APP_LOG_LEVEL);
+
+#if defined(CONFIG_AUDIO_DSP_F32) || defined(CONFIG_AUDIO_Q15_ACCURACY)
+#define AUDIO_DSP_USE_F32 1
+#endif
+
+/*
+ * Hann windows of every FFT size in .rodata, generated at build time by
+ * scripts/gen_audio_tables.py. The FFT twiddles are the constant
+ * CMSIS-DSP tables selected by the instance init.
+ */
+#include "audio_dsp_tables.inc"
+
+BUILD_ASSERT(AUDIO_DSP_TABLE_MIN_SIZE == AUDIO_FFT_SIZE_MIN &&
+             (AUDIO_DSP_TABLE_MIN_SIZE << (AUDIO_DSP_TABLE_COUNT - 1)) == AUDIO_FFT_SIZE_MAX,
+             "generated tables must cover every configurable FFT size");
+
+#if CONFIG_AUDIO_DECIMATION > 1
+/*
+ * Anti-alias lowpass of the decimation stage, Kaiser windowed sinc
+ * (beta 5.65) in Q15 with unity DC gain. Alias free up to 0.4 of the
+ * decimated rate with 0.01 dB ripple and 59 dB (2) or 62 dB (4)
+ * stopband attenuation.
+ */
+#if CONFIG_AUDIO_DECIMATION == 2
+/* 16 kHz to 8 kHz, passband 3.2 kHz, stopband from 4.8 kHz */
+static const q15_t decim_coeffs[] = {
+    -8, -16, 28, 45, -68, -97, 135, 183, -242, -316,
+    408, 521, -664, -847, 1090, 1428, -1940, -2829, 4844, 14729,
+    14729, 4844, -2829, -1940, 1428, 1090, -847, -664, 521, 408,
+    -316, -242, 183, 135, -97, -68, 45, 28, -16, -8
+};
+#elif CONFIG_AUDIO_DECIMATION == 4
+/* 16 kHz to 4 kHz, passband 1.6 kHz, stopband from 2.4 kHz */
+static const q15_t decim_coeffs[] = {
+    -5, -3, 5, 15, 20, 11, -13, -40, -49, -24,
+    29, 84, 99, 48, -56, -156, -179, -85, 98, 269,
+    306, 144, -163, -447, -507, -238, 271, 748, 858, 411,
+    -480, -1372, -1657, -855, 1115, 3810, 6397, 7978, 7978, 6397,
+    3810, 1115, -855, -1657, -1372, -480, 411, 858, 748, 271,
+    -238, -507, -447, -163, 144, 306, 269, 98, -85, -179,
+    -156, -56, 48, 99, 84, 29, -24, -49, -40, -13,
+    11, 20, 15, 5, -3, -5
+};
+#else
+#error "Unsupported CONFIG_AUDIO_DECIMATION"
+#endif
+
+/* Input samples filtered per call of arm_fir_decimate_q15 */
+#define DECIM_BLOCK 256
+#define DECIM_TAPS  ARRAY_SIZE(decim_coeffs)
+
+static struct {
+    arm_fir_decimate_instance_q15 instance;
+    q15_t state[DECIM_TAPS + DECIM_BLOCK - 1];
+    q15_t output[DECIM_BLOCK / CONFIG_AUDIO_DECIMATION];
+    uint32_t blocks;
+    uint64_t cycles;
+} decim;
+#endif /* CONFIG_AUDIO_DECIMATION > 1 */
+
+/* FFT buffers of every layout are carved from this */
+static uint8_t __aligned(4) dsp_scratch[CONFIG_AUDIO_DSP_SCRATCH_SIZE];
+
+/* Spectrum layout and accumulation state */
+static struct {
+    uint16_t fft_size;
+    uint8_t band_count;
+    fft_band_config_t bands[AUDIO_MAX_BANDS];
+
+    /* Contiguous FFT bin range of each band */
+    struct {
+        uint16_t first;
+        uint16_t count;
+    } band_bins[AUDIO_MAX_BANDS];
+
+    /* Bins spanned by all bands */
+    uint16_t mag_first;
+    uint16_t mag_count;
+
+    /* Bins whose powers are computed per segment, the band span plus the mel filters */
+    uint16_t pow_first;
+    uint16_t pow_count;
+
+#ifdef AUDIO_DSP_USE_F32
+    /* The real FFT needs separate input and packed output */
+    float32_t *fft_input;
+    float32_t *fft_output;
+    const float32_t *window;
+    arm_rfft_fast_instance_f32 fft_instance;
+#endif
+#ifdef CONFIG_AUDIO_DSP_Q15
+    q15_t *fft_input_q15;
+    q15_t *fft_output_q15;
+    const q15_t *window_q15;
+    arm_rfft_instance_q15 fft_instance_q15;
+    float32_t q15_power_scale;
+#endif
+
+    float32_t gain_scale; /* Removes the capture gain offset from bin powers */
+    int8_t gain_offset;
+
+    int16_t *frame;       /* Segment being assembled */
+    uint16_t frame_fill;  /* Samples in frame */
+    float32_t *psd_sum;   /* Welch power spectrum sum per bin */
+
+    float32_t level_mean[AUDIO_MAX_BANDS]; /* Running band level mean, dB */
+    float32_t level_m2[AUDIO_MAX_BANDS];   /* Running band level squared deviations */
+#ifdef CONFIG_AUDIO_Q15_ACCURACY
+    float32_t band_sum_ref[AUDIO_MAX_BANDS]; /* Float path reference */
+#endif
+
+    uint32_t frames;
+    uint32_t frame_cycles_max;
+    uint64_t frame_cycles;
+    uint64_t band_cycles;
+} dsp;
+
+/* Take the next 4-byte aligned buffer from the scratch memory */
+static void *scratch_take(size_t *offset, size_t size)
+{
+    void *buf = &dsp_scratch[*offset];
+
+    *offset += ROUND_UP(size, 4);
+    return buf;
+}
+
+size_t audio_dsp_ram_required(uint16_t fft_size)
+{
+    size_t size = 0;
+
+#ifdef AUDIO_DSP_USE_F32
+    size += 2 * fft_size * sizeof(float32_t);
+#endif
+#ifdef CONFIG_AUDIO_DSP_Q15
+    /* arm_rfft_q15 writes the full 2N spectrum */
+    size += 3 * fft_size * sizeof(q15_t);
+#endif
+    size += fft_size * sizeof(int16_t);
+    size += (fft_size / 2) * sizeof(float32_t);
+#ifdef CONFIG_AUDIO_MFCC
+    size += audio_mfcc_ram_required(fft_size);
+#endif
+
+    return size;
+}
+
+/*
+ * A bin belongs to a band when its truncated centre frequency lies
+ * within the band edges, bins only rise in frequency so each band maps
+ * to one contiguous range. Bin 0 (DC) is never included. The range
+ * edges follow from the band edges directly: floor(k * fs / N) >= start
+ * from k = ceil(start * N / fs), and <= end below ceil((end + 1) * N / fs).
+ */
+static void band_map_init(void)
+{
+    uint16_t last = 0;
+
+    dsp.mag_first = dsp.fft_size / 2;
+
+    for (int band = 0; band < dsp.band_count; band++) {
+        uint32_t first = DIV_ROUND_UP((uint32_t)dsp.bands[band].start_freq * dsp.fft_size,
+                                      AUDIO_FFT_SAMPLE_RATE);
+        uint32_t end = DIV_ROUND_UP(((uint32_t)dsp.bands[band].end_freq + 1) * dsp.fft_size,
+                                    AUDIO_FFT_SAMPLE_RATE);
+
+        first = MAX(first, 1);
+        end = MIN(end, dsp.fft_size / 2);
+        dsp.band_bins[band].first = (end > first) ? first : 0;
+        dsp.band_bins[band].count = (end > first) ? end - first : 0;
+
+        if (dsp.band_bins[band].count > 0) {
+            dsp.mag_first = MIN(dsp.mag_first, dsp.band_bins[band].first);
+            last = MAX(last, dsp.band_bins[band].first + dsp.band_bins[band].count - 1);
+        } else {
+            LOG_WRN("Band %u-%u Hz has no FFT bin at size %u",
+                    dsp.bands[band].start_freq, dsp.bands[band].end_freq, dsp.fft_size);
+        }
+    }
+
+    dsp.mag_count = (last >= dsp.mag_first) ? (last - dsp.mag_first + 1) : 0;
+    dsp.pow_first = dsp.mag_first;
+    dsp.pow_count = dsp.mag_count;
+}
+
+int audio_dsp_setup(uint16_t fft_size, const fft_band_config_t *bands, uint8_t band_count)
+{
+    size_t offset = 0;
+    int table;
+
+    if (!bands || band_count == 0 || band_count > AUDIO_MAX_BANDS) {
+        return -EINVAL;
+    }
+
+    if (fft_size < AUDIO_FFT_SIZE_MIN || fft_size > AUDIO_FFT_SIZE_MAX ||
+        !IS_POWER_OF_TWO(fft_size)) {
+        return -EINVAL;
+    }
+
+    for (int band = 0; band < band_count; band++) {
+        if (bands[band].start_freq > bands[band].end_freq ||
+            bands[band].end_freq > AUDIO_FFT_SAMPLE_RATE / 2) {
+            return -EINVAL;
+        }
+    }
+
+    if (audio_dsp_ram_required(fft_size) > sizeof(dsp_scratch)) {
+        LOG_ERR("FFT size %u needs %zu bytes, scratch is %zu", fft_size,
+                audio_dsp_ram_required(fft_size), sizeof(dsp_scratch));
+        return -ENOMEM;
+    }
+
+    /* Generated tables start at the smallest size, one per power of two */
+    table = __builtin_ctz(fft_size) - __builtin_ctz(AUDIO_FFT_SIZE_MIN);
+
+    dsp.fft_size = fft_size;
+    dsp.band_count = band_count;
+    dsp.gain_offset = 0;
+    dsp.gain_scale = 1.0f;
+    memcpy(dsp.bands, bands, band_count * sizeof(fft_band_config_t));
+
+    /* Carve buffers */
+#ifdef AUDIO_DSP_USE_F32
+    dsp.fft_input = scratch_take(&offset, fft_size * sizeof(float32_t));
+    dsp.fft_output = scratch_take(&offset, fft_size * sizeof(float32_t));
+    dsp.window = hann_f32[table];
+    arm_rfft_fast_init_f32(&dsp.fft_instance, fft_size);
+#endif
+#ifdef CONFIG_AUDIO_DSP_Q15
+    dsp.fft_input_q15 = scratch_take(&offset, fft_size * sizeof(q15_t));
+    dsp.fft_output_q15 = scratch_take(&offset, 2 * fft_size * sizeof(q15_t));
+    dsp.window_q15 = hann_q15[table];
+    arm_rfft_init_q15(&dsp.fft_instance_q15, fft_size, 0, 1);
+    /*
+     * arm_rfft_q15 returns the spectrum scaled down by N. This converts
+     * the squared magnitude of an output bin back to float path units.
+     */
+    dsp.q15_power_scale = (float32_t)fft_size * fft_size / (32768.0f * 32768.0f);
+#endif
+    dsp.frame = scratch_take(&offset, fft_size * sizeof(int16_t));
+    dsp.psd_sum = scratch_take(&offset, (fft_size / 2) * sizeof(float32_t));
+
+    band_map_init();
+#ifdef CONFIG_AUDIO_MFCC
+    uint16_t mel_first, mel_count;
+
+    audio_mfcc_setup(fft_size, scratch_take(&offset, audio_mfcc_ram_required(fft_size)),
+                     &mel_first, &mel_count);
+    if (mel_count > 0) {
+        uint16_t end = MAX(dsp.pow_first + dsp.pow_count, mel_first + mel_count);
+
+        dsp.pow_first = (dsp.pow_count > 0) ? MIN(dsp.pow_first, mel_first) : mel_first;
+        dsp.pow_count = end - dsp.pow_first;
+    }
+#endif
+#if CONFIG_AUDIO_DECIMATION > 1
+    arm_fir_decimate_init_q15(&decim.instance, DECIM_TAPS, CONFIG_AUDIO_DECIMATION,
+                              decim_coeffs, decim.state, DECIM_BLOCK);
+#endif
+    audio_dsp_reset();
+
+    LOG_INF("Spectrum layout: FFT %u, %u bands, %zu bytes", fft_size, band_count, offset);
+    return 0;
+}
+
+void audio_dsp_reset(void)
+{
+    memset(dsp.psd_sum, 0, (dsp.fft_size / 2) * sizeof(float32_t));
+    memset(dsp.level_mean, 0, sizeof(dsp.level_mean));
+    memset(dsp.level_m2, 0, sizeof(dsp.level_m2));
+#ifdef CONFIG_AUDIO_Q15_ACCURACY
+    memset(dsp.band_sum_ref, 0, sizeof(dsp.band_sum_ref));
+#endif
+    dsp.frame_fill = 0;
+#if CONFIG_AUDIO_DECIMATION > 1
+    memset(decim.state, 0, sizeof(decim.state));
+    decim.blocks = 0;
+    decim.cycles = 0;
+#endif
+#ifdef CONFIG_AUDIO_MFCC
+    audio_mfcc_reset();
+#endif
+    dsp.frames = 0;
+    dsp.frame_cycles = 0;
+    dsp.frame_cycles_max = 0;
+    dsp.band_cycles = 0;
+}
+
+/* Level in dB relative to one int16 LSB, 0 dB for silence */
+static float32_t power_to_db(float32_t power)
+{
+    /* Powers are in float path units, samples scaled by 1/32768 */
+    float32_t db = 10.0f * log10f(power + 1e-12f) + AUDIO_LSB_DB;
+
+    return MAX(db, 0.0f);
+}
+
+/* Add one segment's band powers to the per-band level statistics */
+static void band_stats_update(const float32_t *band_power)
+{
+    uint32_t n = dsp.frames + 1;
+
+    /* Welford's running mean and variance of the band level */
+    for (int band = 0; band < dsp.band_count; band++) {
+        float32_t level = power_to_db(band_power[band]);
+        float32_t delta = level - dsp.level_mean[band];
+
+        dsp.level_mean[band] += delta / n;
+        dsp.level_m2[band] += delta * (level - dsp.level_mean[band]);
+    }
+}
+
+#ifdef AUDIO_DSP_USE_F32
+/* Average bin powers over each band */
+static void reduce_bands_f32(const float32_t *power, float32_t *band_power)
+{
+    for (int band = 0; band < dsp.band_count; band++) {
+        if (dsp.band_bins[band].count > 0) {
+            arm_mean_f32(&power[dsp.band_bins[band].first], dsp.band_bins[band].count,
+                         &band_power[band]);
+        } else {
+            band_power[band] = 0;
+        }
+    }
+}
+
+/*
+ * Windowed real FFT of one segment, leaves bin powers in fft_input
+ * (consumed by the transform). The packed arm_rfft_fast_f32 output
+ * holds DC and Nyquist in [0], [1] and bin k (1 <= k < N/2) as the
+ * complex pair at [2k], [2k+1]. Bands never include DC or Nyquist.
+ */
+static void spectrum_frame_f32(const int16_t *samples)
+{
+    /* Convert samples to float and apply window in one pass */
+    for (int i = 0; i < dsp.fft_size; i++) {
+        dsp.fft_input[i] = (float32_t)samples[i] * dsp.window[i];
+    }
+
+    arm_rfft_fast_f32(&dsp.fft_instance, dsp.fft_input, dsp.fft_output, 0);
+
+    /* Powers of the bins used by any band or mel filter, in one pass */
+    arm_cmplx_mag_squared_f32(&dsp.fft_output[2 * dsp.pow_first],
+                              &dsp.fft_input[dsp.pow_first], dsp.pow_count);
+    if (dsp.gain_offset != 0) {
+        arm_scale_f32(&dsp.fft_input[dsp.pow_first], dsp.gain_scale,
+                      &dsp.fft_input[dsp.pow_first], dsp.pow_count);
+    }
+}
+
+static void accumulate_frame_f32(float32_t *band_power)
+{
+    arm_add_f32(&dsp.psd_sum[dsp.mag_first], &dsp.fft_input[dsp.mag_first],
+                &dsp.psd_sum[dsp.mag_first], dsp.mag_count);
+    reduce_bands_f32(dsp.fft_input, band_power);
+}
+#endif /* AUDIO_DSP_USE_F32 */
+
+#ifdef CONFIG_AUDIO_DSP_Q15
+/* Windowed Q15 real FFT of one segment, bin k is the pair at [2k], [2k+1] */
+static void spectrum_frame_q15(const int16_t *samples)
+{
+    /* Samples are already Q15, window them directly */
+    arm_mult_q15(samples, dsp.window_q15, dsp.fft_input_q15, dsp.fft_size);
+
+    arm_rfft_q15(&dsp.fft_instance_q15, dsp.fft_input_q15, dsp.fft_output_q15);
+}
+
+/*
+ * Raw power of one Q15 bin. Computed in 32 bits rather than with
+ * arm_cmplx_mag_squared_q15, whose 3.13 output would drop everything
+ * below about 105 dB on top of the FFT's own downscaling.
+ */
+static inline uint32_t bin_power_q15(int bin)
+{
+    int32_t re = dsp.fft_output_q15[2 * bin];
+    int32_t im = dsp.fft_output_q15[2 * bin + 1];
+
+    return (uint32_t)(re * re) + (uint32_t)(im * im);
+}
+
+/* Accumulate Q15 bin powers and average them per band, in float path units */
+static void accumulate_frame_q15(float32_t *band_power)
+{
+    const float32_t scale = dsp.q15_power_scale * dsp.gain_scale;
+
+    for (int bin = dsp.mag_first; bin < dsp.mag_first + dsp.mag_count; bin++) {
+        dsp.psd_sum[bin] += (float32_t)bin_power_q15(bin) * scale;
+    }
+
+    for (int band = 0; band < dsp.band_count; band++) {
+        uint64_t band_sum = 0;
+
+        if (dsp.band_bins[band].count == 0) {
+            band_power[band] = 0;
+            continue;
+        }
+
+        for (int i = 0; i < dsp.band_bins[band].count; i++) {
+            band_sum += bin_power_q15(dsp.band_bins[band].first + i);
+        }
+        band_power[band] = (float32_t)band_sum * scale / dsp.band_bins[band].count;
+    }
+}
+#endif /* CONFIG_AUDIO_DSP_Q15 */
+
+void audio_dsp_set_gain_offset(int8_t db)
+{
+    if (db != dsp.gain_offset) {
+        dsp.gain_offset = db;
+        dsp.gain_scale = powf(10.0f, -db / 10.0f);
+    }
+}
+
+/* Transform one Welch segment and add it to the recording statistics */
+static void process_frame(const int16_t *samples)
+{
+    float32_t band_power[AUDIO_MAX_BANDS];
+    uint32_t start = k_cycle_get_32();
+    uint32_t bands_start;
+
+#ifdef CONFIG_AUDIO_DSP_Q15
+    spectrum_frame_q15(samples);
+    bands_start = k_cycle_get_32();
+    accumulate_frame_q15(band_power);
+#else
+    spectrum_frame_f32(samples);
+    bands_start = k_cycle_get_32();
+    accumulate_frame_f32(band_power);
+#ifdef CONFIG_AUDIO_MFCC
+    audio_mfcc_frame(dsp.fft_input);
+#endif
+#endif
+    band_stats_update(band_power);
+
+    uint32_t now = k_cycle_get_32();
+    uint32_t cycles = now - start;
+
+    dsp.frame_cycles += cycles;
+    dsp.band_cycles += now - bands_start;
+    dsp.frame_cycles_max = MAX(dsp.frame_cycles_max, cycles);
+    dsp.frames++;
+
+#ifdef CONFIG_AUDIO_Q15_ACCURACY
+    /* Reference spectrum, outside the cycle measurement */
+    spectrum_frame_f32(samples);
+    reduce_bands_f32(dsp.fft_input, band_power);
+    for (int band = 0; band < dsp.band_count; band++) {
+        dsp.band_sum_ref[band] += band_power[band];
+    }
+#endif
+}
+
+/*
+ * Segments are fft_size long with a hop of half that. Samples are
+ * collected in dsp.frame, which keeps the second half of the previous
+ * segment, so any FFT size works with any block size and memory does
+ * not depend on the recording duration.
+ */
+static void frame_feed(const int16_t *samples, size_t count)
+{
+    const uint16_t hop = dsp.fft_size / 2;
+
+    while (count > 0) {
+        size_t take = MIN(count, (size_t)(dsp.fft_size - dsp.frame_fill));
+
+        memcpy(&dsp.frame[dsp.frame_fill], samples, take * sizeof(int16_t));
+        dsp.frame_fill += take;
+        samples += take;
+        count -= take;
+
+        if (dsp.frame_fill == dsp.fft_size) {
+            process_frame(dsp.frame);
+            memmove(dsp.frame, &dsp.frame[hop], (dsp.fft_size - hop) * sizeof(int16_t));
+            dsp.frame_fill = dsp.fft_size - hop;
+        }
+    }
+}
+
+void audio_dsp_process(const int16_t *samples, size_t count, bool gap)
+{
+    /* Samples were lost, do not join segments across the gap */
+    if (gap) {
+        dsp.frame_fill = 0;
+#if CONFIG_AUDIO_DECIMATION > 1
+        memset(decim.state, 0, sizeof(decim.state));
+#endif
+    }
+
+#if CONFIG_AUDIO_DECIMATION > 1
+    /* I2S blocks are a multiple of the factor, the filter keeps its history */
+    __ASSERT_NO_MSG(count % CONFIG_AUDIO_DECIMATION == 0);
+
+    while (count >= CONFIG_AUDIO_DECIMATION) {
+        size_t take = MIN(count, DECIM_BLOCK);
+        uint32_t start = k_cycle_get_32();
+
+        take -= take % CONFIG_AUDIO_DECIMATION;
+        arm_fir_decimate_q15(&decim.instance, samples, decim.output, take);
+        decim.cycles += k_cycle_get_32() - start;
+        samples += take;
+        count -= take;
+
+        frame_feed(decim.output, take / CONFIG_AUDIO_DECIMATION);
+    }
+
+    decim.blocks++;
+#else
+    frame_feed(samples, count);
+#endif
+}
+
+/* Welch estimate of a band: mean power over its bins and all segments */
+static float32_t band_mean_power(int band)
+{
+    float32_t sum = 0;
+
+    if (dsp.band_bins[band].count == 0 || dsp.frames == 0) {
+        return 0;
+    }
+
+    for (int i = 0; i < dsp.band_bins[band].count; i++) {
+        sum += dsp.psd_sum[dsp.band_bins[band].first + i];
+    }
+
+    return sum / (dsp.band_bins[band].count * dsp.frames);
+}
+
+int audio_dsp_get_levels(uint16_t *mean, uint16_t *var)
+{
+    if (dsp.frames == 0) {
+        return -ENODATA;
+    }
+
+    for (int band = 0; band < dsp.band_count; band++) {
+        float32_t level = power_to_db(band_mean_power(band)) * AUDIO_LEVEL_SCALE;
+        float32_t v = 0;
+
+        if (dsp.frames > 1) {
+            v = dsp.level_m2[band] / (dsp.frames - 1) * AUDIO_LEVEL_SCALE;
+        }
+
+        mean[band] = (uint16_t)MIN(level, UINT16_MAX);
+        var[band] = (uint16_t)MIN(v, UINT16_MAX);
+    }
+
+    return dsp.band_count;
+}
+
+/* Roll-off point, share of the total power */
+#define ROLLOFF_SHARE 0.85f
+
+int audio_dsp_get_features(AUDIO_FEATURES_s *features, uint16_t split_freq)
+{
+    const float32_t bin_hz = (float32_t)AUDIO_FFT_SAMPLE_RATE / dsp.fft_size;
+    const uint16_t first = dsp.mag_first;
+    const uint16_t last = dsp.mag_first + dsp.mag_count;
+    float32_t total = 0;
+    float32_t weighted = 0;
+    float32_t log_sum = 0;
+    float32_t low = 0;
+    float32_t cumulative = 0;
+
+    if (dsp.frames == 0 || dsp.mag_count == 0) {
+        return -ENODATA;
+    }
+
+    /* Frame count scales every bin alike, the sums are used unnormalised */
+    for (int bin = first; bin < last; bin++) {
+        float32_t power = dsp.psd_sum[bin];
+
+        total += power;
+        weighted += power * bin * bin_hz;
+        log_sum += logf(power + 1e-12f);
+        if (bin * bin_hz < split_freq) {
+            low += power;
+        }
+    }
+
+    features->rolloff = (uint16_t)((last - 1) * bin_hz);
+    for (int bin = first; bin < last; bin++) {
+        cumulative += dsp.psd_sum[bin];
+        if (cumulative >= ROLLOFF_SHARE * total) {
+            features->rolloff = (uint16_t)(bin * bin_hz);
+            break;
+        }
+    }
+
+    float32_t mean = total / dsp.mag_count;
+    float32_t flatness = (mean > 0.0f) ? expf(log_sum / dsp.mag_count) / mean : 0.0f;
+    float32_t high = total - low;
+    float32_t ratio_db = 10.0f * log10f((low + 1e-12f) / (high + 1e-12f));
+
+    features->centroid = (total > 0.0f) ? (uint16_t)(weighted / total) : 0;
+    features->level = (uint16_t)MIN(power_to_db(total / dsp.frames) * AUDIO_LEVEL_SCALE,
+                                    UINT16_MAX);
+    features->flatness = (uint8_t)(CLAMP(flatness, 0.0f, 1.0f) * UINT8_MAX + 0.5f);
+    features->low_high = (int8_t)CLAMP(lroundf(2.0f * ratio_db), INT8_MIN, INT8_MAX);
+    return 0;
+}
+
+void audio_dsp_get_stats(audio_stats_t *stats)
+{
+    stats->frames = dsp.frames;
+    stats->frame_cycles_max = dsp.frame_cycles_max;
+    stats->frame_cycles_avg = dsp.frames ? dsp.frame_cycles / dsp.frames : 0;
+    stats->band_cycles_avg = dsp.frames ? dsp.band_cycles / dsp.frames : 0;
+#if CONFIG_AUDIO_DECIMATION > 1
+    stats->decim_cycles_avg = decim.blocks ? decim.cycles / decim.blocks : 0;
+#else
+    stats->decim_cycles_avg = 0;
+#endif
+}
+
+const int16_t *audio_dsp_decim_filter(size_t *taps)
+{
+#if CONFIG_AUDIO_DECIMATION > 1
+    *taps = DECIM_TAPS;
+    return decim_coeffs;
+#else
+    *taps = 0;
+    return NULL;
+#endif
+}
+
+#ifdef CONFIG_AUDIO_Q15_ACCURACY
+/* Log the error of the averaged Q15 band powers against the float reference */
+static void accuracy_report(void)
+{
+    int32_t worst = 0;
+
+    for (int band = 0; band < dsp.band_count; band++) {
+        float32_t ref = dsp.band_sum_ref[band] / dsp.frames;
+        float32_t err = band_mean_power(band) - ref;
+        /* Relative error in 0.1 % units */
+        int32_t permille = (ref > 0.0f) ? (int32_t)(1000.0f * err / ref) : 0;
+        int32_t mag = abs(permille);
+
+        LOG_INF("Q15 band %d (%u-%u Hz): power error %s%d.%d %%", band,
+                dsp.bands[band].start_freq, dsp.bands[band].end_freq,
+                (permille < 0) ? "-" : "", mag / 10, mag % 10);
+        worst = MAX(worst, mag);
+    }
+
+    LOG_INF("Q15 worst band power error %d.%d %%", worst / 10, worst % 10);
+}
+#endif
+
+void audio_dsp_report(void)
+{
+    audio_stats_t stats;
+
+    if (dsp.frames == 0) {
+        return;
+    }
+
+    audio_dsp_get_stats(&stats);
+    LOG_INF("Audio frame cycles: avg %u, max %u, bands avg %u",
+            stats.frame_cycles_avg, stats.frame_cycles_max, stats.band_cycles_avg);
+#if CONFIG_AUDIO_DECIMATION > 1
+    LOG_INF("Audio decimation by %d: %u cycles per block",
+            CONFIG_AUDIO_DECIMATION, stats.decim_cycles_avg);
+#endif
+
+#ifdef CONFIG_AUDIO_Q15_ACCURACY
+    accuracy_report();
+#endif
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef AUDIO_DSP_H
+#define AUDIO_DSP_H
+
+#include <zephyr/kernel.h>
+#include "audio_app.h"
+
+/**
+ * @brief Get scratch memory needed for an FFT size
+ *
+ * @param fft_size FFT length in samples
+ * @return Bytes of CONFIG_AUDIO_DSP_SCRATCH_SIZE the layout would use
+ */
+size_t audio_dsp_ram_required(uint16_t fft_size);
+
+/**
+ * @brief Set up the spectrum layout
+ *
+ * Validates the layout, carves the FFT buffers from the scratch memory
+ * and precomputes the window and bin-to-band map. Must not be called
+ * while a recording is processed.
+ *
+ * @param fft_size FFT length, power of 2 from AUDIO_FFT_SIZE_MIN to AUDIO_FFT_SIZE_MAX
+ * @param bands Band edges in Hz
+ * @param band_count Number of bands, 1 to AUDIO_MAX_BANDS
+ * @return 0 on success, -EINVAL for an invalid layout, -ENOMEM if the
+ *         buffers do not fit the scratch memory
+ */
+int audio_dsp_setup(uint16_t fft_size, const fft_band_config_t *bands, uint8_t band_count);
+
+/**
+ * @brief Clear accumulated spectra for a new recording
+ */
+void audio_dsp_reset(void);
+
+/**
+ * @brief Set the capture gain to remove from the levels
+ *
+ * Segments are scaled back by the gain, so levels stay comparable
+ * when the codec gain changes during a recording.
+ *
+ * @param db Capture gain above the reference gain in dB
+ */
+void audio_dsp_set_gain_offset(int8_t db);
+
+/**
+ * @brief Feed captured samples
+ *
+ * Samples are split into Hann windowed segments of the FFT size with
+ * 50% overlap, continued across calls.
+ *
+ * @param samples Sample buffer
+ * @param count Number of samples
+ * @param gap true if samples were lost before this buffer
+ */
+void audio_dsp_process(const int16_t *samples, size_t count, bool gap);
+
+/**
+ * @brief Get Welch band levels of the recording so far
+ *
+ * @param mean Array of band_count entries to store the mean band level
+ *             in 1/AUDIO_LEVEL_SCALE dB
+ * @param var Array of band_count entries to store the variance of the
+ *            per-segment level in 1/AUDIO_LEVEL_SCALE dB^2
+ * @return Number of bands, -ENODATA if no segment was processed
+ */
+int audio_dsp_get_levels(uint16_t *mean, uint16_t *var);
+
+/**
+ * @brief Get spectral features of the recording so far
+ *
+ * Derived from the Welch spectrum over the bins of the configured
+ * bands, no per-segment work is added.
+ *
+ * @param features Pointer to store features
+ * @param split_freq Frequency in Hz separating the low and high power
+ * @return 0 on success, -ENODATA if no segment was processed
+ */
+int audio_dsp_get_features(AUDIO_FEATURES_s *features, uint16_t split_freq);
+
+/**
+ * @brief Get segment and cycle counters
+ *
+ * Fills the frame and cycle fields of the statistics.
+ *
+ * @param stats Pointer to store counters
+ */
+void audio_dsp_get_stats(audio_stats_t *stats);
+
+/**
+ * @brief Get the decimation filter ahead of the FFT
+ *
+ * @param taps Pointer to store the number of taps
+ * @return Q15 coefficients, newest sample first, NULL without decimation
+ */
+const int16_t *audio_dsp_decim_filter(size_t *taps);
+
+/**
+ * @brief Log processing cost and, if enabled, Q15 accuracy
+ */
+void audio_dsp_report(void);
+
+#endif /* AUDIO_DSP_H */
@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include "audio_app.h"
+
+uint8_t audio_app_encoded_size(audio_encoding_t encoding, uint8_t band_count)
+{
+    size_t size;
+
+    switch (encoding) {
+    case AUDIO_ENCODING_U16:
+        size = FFT_HEADER_SIZE + band_count * FFT_BYTES_PER_BAND;
+        break;
+    case AUDIO_ENCODING_DB8:
+        size = FFT_HEADER_SIZE + 1 + band_count;
+        break;
+    case AUDIO_ENCODING_DELTA4:
+        size = FFT_HEADER_SIZE + 2 + band_count / 2;
+        break;
+    default:
+        return 0;
+    }
+
+    return (size <= FFT_MAX_PAYLOAD) ? size : 0;
+}
+
+BUILD_ASSERT(ZOOM_HEADER_SIZE + 1 + ZOOM_UPLINK_BINS <= FFT_MAX_PAYLOAD,
+             "Zoom uplink bins do not fit the payload");
+BUILD_ASSERT(ZOOM_UPLINK_BINS % 2 == 1, "Zoom uplink bins must keep the centre bin");
+
+/* Reference byte and one step count per level, see AUDIO_ENCODING_DB8 */
+static void encode_db8(const uint16_t *levels, int count, uint8_t *data)
+{
+    /* Reference is the loudest level rounded up to a whole dB */
+    uint16_t max = 0;
+
+    for (int i = 0; i < count; i++) {
+        max = MAX(max, levels[i]);
+    }
+
+    uint32_t ref = MIN(DIV_ROUND_UP(max, AUDIO_LEVEL_SCALE), UINT8_MAX);
+    data[0] = ref;
+
+    for (int i = 0; i < count; i++) {
+        int32_t below = ref * AUDIO_LEVEL_SCALE - levels[i];
+
+        below = MAX(below, 0);
+        data[1 + i] = MIN((below + AUDIO_DB8_STEP / 2) / AUDIO_DB8_STEP, UINT8_MAX);
+    }
+}
+
+static void decode_db8(const uint8_t *data, int count, uint16_t *levels)
+{
+    for (int i = 0; i < count; i++) {
+        int32_t level = data[0] * AUDIO_LEVEL_SCALE - data[1 + i] * AUDIO_DB8_STEP;
+
+        levels[i] = MAX(level, 0);
+    }
+}
+
+/* Round a signed level difference to the nearest delta step */
+static int delta_step(int32_t diff)
+{
+    int q = (diff >= 0) ? (diff + AUDIO_DELTA4_STEP / 2) / AUDIO_DELTA4_STEP :
+                          -((-diff + AUDIO_DELTA4_STEP / 2) / AUDIO_DELTA4_STEP);
+
+    return CLAMP(q, -8, 7);
+}
+
+int audio_app_encode_fft(const FFT_RESULT_s *result, uint8_t *payload, uint8_t *size)
+{
+    uint8_t *data = &payload[FFT_HEADER_SIZE];
+    uint8_t total;
+
+    if (!result || !payload || !size) {
+        return -EINVAL;
+    }
+
+    /* Check maximum payload size */
+    if (result->band_count == 0 || result->band_count > AUDIO_MAX_BANDS) {
+        return -EINVAL;
+    }
+
+    total = audio_app_encoded_size(result->encoding, result->band_count);
+    if (total == 0) {
+        return -ENOSPC;
+    }
+
+    /* Encode header */
+    payload[0] = (result->timestamp >> 24) & 0xFF;
+    payload[1] = (result->timestamp >> 16) & 0xFF;
+    payload[2] = (result->timestamp >> 8) & 0xFF;
+    payload[3] = result->timestamp & 0xFF;
+    payload[4] = result->config;
+    payload[5] = (result->encoding << 6) | result->band_count;
+
+    switch (result->encoding) {
+    case AUDIO_ENCODING_U16:
+        for (int i = 0; i < result->band_count; i++) {
+            data[i * 2] = (result->magnitude[i] >> 8) & 0xFF;
+            data[i * 2 + 1] = result->magnitude[i] & 0xFF;
+        }
+        break;
+
+    case AUDIO_ENCODING_DB8:
+        encode_db8(result->magnitude, result->band_count, data);
+        break;
+
+    case AUDIO_ENCODING_DELTA4: {
+        /* Deltas follow the decoded level, so errors do not accumulate */
+        int32_t level = result->magnitude[0];
+
+        data[0] = (result->magnitude[0] >> 8) & 0xFF;
+        data[1] = result->magnitude[0] & 0xFF;
+
+        for (int i = 1; i < result->band_count; i++) {
+            int q = delta_step((int32_t)result->magnitude[i] - level);
+            uint8_t *byte = &data[2 + (i - 1) / 2];
+
+            level = MAX(level + q * AUDIO_DELTA4_STEP, 0);
+            if ((i - 1) % 2 == 0) {
+                *byte = (q & 0x0F) << 4;
+            } else {
+                *byte |= q & 0x0F;
+            }
+        }
+        break;
+    }
+
+    default:
+        return -EINVAL;
+    }
+
+    *size = total;
+    return 0;
+}
+
+int audio_app_decode_fft(const uint8_t *payload, uint8_t size, FFT_RESULT_s *result)
+{
+    const uint8_t *data = &payload[FFT_HEADER_SIZE];
+
+    if (!payload || !result || size < FFT_HEADER_SIZE) {
+        return -EINVAL;
+    }
+
+    /* Decode header */
+    result->timestamp = ((uint32_t)payload[0] << 24) |
+                       ((uint32_t)payload[1] << 16) |
+                       ((uint32_t)payload[2] << 8) |
+                       payload[3];
+    result->config = payload[4];
+    result->encoding = payload[5] >> 6;
+    result->band_count = payload[5] & 0x3F;
+    result->size = 256 << (result->config & 0x07);
+    result->frequency = 0;
+
+    if (result->band_count == 0 || result->band_count > AUDIO_MAX_BANDS) {
+        return -EINVAL;
+    }
+
+    uint8_t expected = audio_app_encoded_size(result->encoding, result->band_count);
+    if (expected == 0 || size < expected) {
+        return -EINVAL;
+    }
+
+    /* Decode band levels */
+    switch (result->encoding) {
+    case AUDIO_ENCODING_U16:
+        for (int i = 0; i < result->band_count; i++) {
+            result->magnitude[i] = ((uint16_t)data[i * 2] << 8) | data[i * 2 + 1];
+        }
+        break;
+
+    case AUDIO_ENCODING_DB8:
+        decode_db8(data, result->band_count, result->magnitude);
+        break;
+
+    case AUDIO_ENCODING_DELTA4: {
+        int32_t level = ((uint16_t)data[0] << 8) | data[1];
+
+        result->magnitude[0] = level;
+        for (int i = 1; i < result->band_count; i++) {
+            uint8_t byte = data[2 + (i - 1) / 2];
+            uint8_t nibble = ((i - 1) % 2 == 0) ? (byte >> 4) : (byte & 0x0F);
+            /* Sign extend the 4-bit step */
+            int q = (nibble & 0x08) ? (int)nibble - 16 : nibble;
+
+            level = MAX(level + q * AUDIO_DELTA4_STEP, 0);
+            result->magnitude[i] = level;
+        }
+        break;
+    }
+    }
+
+    return 0;
+}
+
+int audio_app_encode_zoom(const AUDIO_ZOOM_s *zoom, uint8_t *payload, uint8_t *size)
+{
+    uint16_t count;
+    uint16_t first;
+
+    if (!zoom || !payload || !size || zoom->count == 0 || zoom->count > MAX_ZOOM_BINS) {
+        return -EINVAL;
+    }
+
+    /* Middle bins around the centre, the full spectrum does not fit */
+    count = MIN(zoom->count, ZOOM_UPLINK_BINS);
+    first = (zoom->count - count) / 2;
+
+    payload[0] = (zoom->center_freq >> 8) & 0xFF;
+    payload[1] = zoom->center_freq & 0xFF;
+    payload[2] = (zoom->resolution >> 8) & 0xFF;
+    payload[3] = zoom->resolution & 0xFF;
+    payload[4] = count;
+    encode_db8(&zoom->level[first], count, &payload[ZOOM_HEADER_SIZE]);
+
+    *size = ZOOM_HEADER_SIZE + 1 + count;
+    return 0;
+}
+
+int audio_app_decode_zoom(const uint8_t *payload, uint8_t size, AUDIO_ZOOM_s *zoom)
+{
+    if (!payload || !zoom || size < ZOOM_HEADER_SIZE + 1) {
+        return -EINVAL;
+    }
+
+    zoom->center_freq = ((uint16_t)payload[0] << 8) | payload[1];
+    zoom->resolution = ((uint16_t)payload[2] << 8) | payload[3];
+    zoom->count = payload[4];
+
+    if (zoom->count == 0 || size < ZOOM_HEADER_SIZE + 1 + zoom->count) {
+        return -EINVAL;
+    }
+
+    decode_db8(&payload[ZOOM_HEADER_SIZE], zoom->count, zoom->level);
+    return 0;
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <math.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include "audio_mfcc.h"
+
+LOG_MODULE_REGISTER(audio_mfcc, CONFIG_APP_LOG_LEVEL);
+
+#define MEL_BANDS  CONFIG_AUDIO_MEL_BANDS
+#define MFCC_COUNT CONFIG_AUDIO_MFCC_COUNT
+
+BUILD_ASSERT(MFCC_COUNT <= MEL_BANDS && MFCC_COUNT <= MAX_MFCC,
+             "AUDIO_MFCC_COUNT exceeds the mel bands or the result size");
+
+/* Keeps the log finite for silent bands */
+#define MEL_FLOOR  1e-10f
+
+/* Mel filterbank and cepstrum accumulation state */
+static struct {
+    /* Non-zero weights of each filter, packed one filter after another */
+    float32_t *weights;
+    struct {
+        uint16_t first;    /* First FFT bin */
+        uint16_t count;    /* Number of bins, and of weights */
+        uint16_t offset;   /* Index of the first weight */
+    } filter[MEL_BANDS];
+
+    /* Orthonormal DCT-II as a MFCC_COUNT x MEL_BANDS matrix */
+    float32_t dct[MFCC_COUNT * MEL_BANDS];
+    arm_matrix_instance_f32 dct_matrix;
+
+    float32_t log_sum[MEL_BANDS];
+    uint32_t frames;
+} mfcc;
+
+static float32_t hz_to_mel(float32_t hz)
+{
+    return 2595.0f * log10f(1.0f + hz / 700.0f);
+}
+
+static float32_t mel_to_hz(float32_t mel)
+{
+    return 700.0f * (powf(10.0f, mel / 2595.0f) - 1.0f);
+}
+
+size_t audio_mfcc_ram_required(uint16_t fft_size)
+{
+    /* Overlapping triangles give every bin at most two weights */
+    return 2 * (fft_size / 2) * sizeof(float32_t);
+}
+
+void audio_mfcc_setup(uint16_t fft_size, float32_t *weights, uint16_t *first, uint16_t *count)
+{
+    const float32_t bin_hz = (float32_t)AUDIO_FFT_SAMPLE_RATE / fft_size;
+    const float32_t high = MIN(CONFIG_AUDIO_MEL_HIGH_HZ, AUDIO_FFT_SAMPLE_RATE / 2);
+    const float32_t mel_low = hz_to_mel(CONFIG_AUDIO_MEL_LOW_HZ);
+    const float32_t mel_step = (hz_to_mel(high) - mel_low) / (MEL_BANDS + 1);
+    uint16_t offset = 0;
+    uint16_t last = 0;
+
+    mfcc.weights = weights;
+    *first = fft_size / 2;
+
+    for (int m = 0; m < MEL_BANDS; m++) {
+        /* Triangle from the previous to the next centre frequency */
+        float32_t left = mel_to_hz(mel_low + m * mel_step);
+        float32_t centre = mel_to_hz(mel_low + (m + 1) * mel_step);
+        float32_t right = mel_to_hz(mel_low + (m + 2) * mel_step);
+
+        mfcc.filter[m].first = 0;
+        mfcc.filter[m].count = 0;
+        mfcc.filter[m].offset = offset;
+
+        for (int bin = 1; bin < fft_size / 2; bin++) {
+            float32_t f = bin * bin_hz;
+
+            if (f <= left || f >= right) {
+                continue;
+            }
+
+            if (mfcc.filter[m].count == 0) {
+                mfcc.filter[m].first = bin;
+            }
+            weights[offset++] = (f < centre) ? (f - left) / (centre - left) :
+                                               (right - f) / (right - centre);
+            mfcc.filter[m].count++;
+        }
+
+        if (mfcc.filter[m].count > 0) {
+            *first = MIN(*first, mfcc.filter[m].first);
+            last = MAX(last, mfcc.filter[m].first + mfcc.filter[m].count - 1);
+        } else {
+            LOG_WRN("Mel band %d (%u Hz) has no FFT bin at size %u", m,
+                    (uint16_t)centre, fft_size);
+        }
+    }
+
+    *count = (last >= *first) ? (last - *first + 1) : 0;
+
+    /* DCT-II basis, orthonormal so c0 is the scaled mean */
+    for (int k = 0; k < MFCC_COUNT; k++) {
+        float32_t scale = sqrtf(((k == 0) ? 1.0f : 2.0f) / MEL_BANDS);
+
+        for (int m = 0; m < MEL_BANDS; m++) {
+            mfcc.dct[k * MEL_BANDS + m] = scale * cosf(PI * k * (m + 0.5f) / MEL_BANDS);
+        }
+    }
+    arm_mat_init_f32(&mfcc.dct_matrix, MFCC_COUNT, MEL_BANDS, mfcc.dct);
+
+    audio_mfcc_reset();
+}
+
+void audio_mfcc_reset(void)
+{
+    memset(mfcc.log_sum, 0, sizeof(mfcc.log_sum));
+    mfcc.frames = 0;
+}
+
+void audio_mfcc_frame(const float32_t *power)
+{
+    float32_t energy[MEL_BANDS];
+
+    /* Sparse filterbank, one dot product over each filter's bins */
+    for (int m = 0; m < MEL_BANDS; m++) {
+        energy[m] = 0;
+        if (mfcc.filter[m].count > 0) {
+            arm_dot_prod_f32(&power[mfcc.filter[m].first],
+                             &mfcc.weights[mfcc.filter[m].offset],
+                             mfcc.filter[m].count, &energy[m]);
+        }
+    }
+
+    arm_offset_f32(energy, MEL_FLOOR, energy, MEL_BANDS);
+    arm_vlog_f32(energy, energy, MEL_BANDS);
+    arm_add_f32(mfcc.log_sum, energy, mfcc.log_sum, MEL_BANDS);
+    mfcc.frames++;
+}
+
+int audio_mfcc_get(int16_t *coeff)
+{
+    float32_t mean[MEL_BANDS];
+    float32_t cepstrum[MFCC_COUNT];
+
+    if (mfcc.frames == 0) {
+        return -ENODATA;
+    }
+
+    /* The DCT is linear, so the cepstrum of the mean log is the mean cepstrum */
+    arm_scale_f32(mfcc.log_sum, 1.0f / mfcc.frames, mean, MEL_BANDS);
+    arm_mat_vec_mult_f32(&mfcc.dct_matrix, mean, cepstrum);
+
+    for (int k = 0; k < MFCC_COUNT; k++) {
+        coeff[k] = (int16_t)CLAMP(lroundf(cepstrum[k] * AUDIO_MFCC_SCALE), INT16_MIN, INT16_MAX);
+    }
+
+    return MFCC_COUNT;
+}
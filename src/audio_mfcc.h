@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef AUDIO_MFCC_H
+#define AUDIO_MFCC_H
+
+#include <zephyr/kernel.h>
+#include <arm_math.h>
+#include "audio_app.h"
+
+/**
+ * @brief Get scratch memory needed for the mel weights of an FFT size
+ *
+ * @param fft_size FFT length in samples
+ * @return Upper bound in bytes
+ */
+size_t audio_mfcc_ram_required(uint16_t fft_size);
+
+/**
+ * @brief Precompute the mel filterbank for an FFT size
+ *
+ * Builds CONFIG_AUDIO_MEL_BANDS triangular filters between
+ * CONFIG_AUDIO_MEL_LOW_HZ and CONFIG_AUDIO_MEL_HIGH_HZ, capped at half
+ * the FFT rate, and stores only the non-zero weights.
+ *
+ * @param fft_size FFT length in samples
+ * @param weights Buffer of audio_mfcc_ram_required() bytes
+ * @param first Pointer to store the first FFT bin the filters use
+ * @param count Pointer to store the number of FFT bins the filters use
+ */
+void audio_mfcc_setup(uint16_t fft_size, float32_t *weights, uint16_t *first, uint16_t *count);
+
+/**
+ * @brief Clear the accumulated log mel energies
+ */
+void audio_mfcc_reset(void);
+
+/**
+ * @brief Add one segment
+ *
+ * @param power Bin powers indexed by FFT bin, valid over the bins
+ *              returned by audio_mfcc_setup()
+ */
+void audio_mfcc_frame(const float32_t *power);
+
+/**
+ * @brief Get the mean cepstrum of all segments so far
+ *
+ * DCT-II (orthonormal) of the mean natural log mel energies.
+ *
+ * @param coeff Array of CONFIG_AUDIO_MFCC_COUNT entries to store the
+ *              coefficients in 1/AUDIO_MFCC_SCALE units
+ * @return Number of coefficients, -ENODATA if no segment was added
+ */
+int audio_mfcc_get(int16_t *coeff);
+
+#endif /* AUDIO_MFCC_H */
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <math.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include "audio_tone.h"
+
+LOG_MODULE_REGISTER(audio_tone, CONFIG_APP_LOG_LEVEL);
+
+/* Goertzel filter bank and persistence state */
+static struct {
+    audio_tone_config_t config;
+    float coeff[AUDIO_MAX_TONES];     /* 2 * cos(2 * pi * f / fs) */
+    uint16_t persist_windows;         /* Windows a tone must be present */
+
+    /* Window being accumulated */
+    float s1[AUDIO_MAX_TONES];
+    float s2[AUDIO_MAX_TONES];
+    uint64_t energy;
+    uint16_t fill;
+
+    uint16_t levels[AUDIO_MAX_TONES]; /* Last window, 1/AUDIO_LEVEL_SCALE dB */
+    uint16_t score[AUDIO_MAX_TONES];  /* Present windows minus absent windows */
+    uint32_t alarmed;                 /* Tones alarmed, rearmed once the score is 0 */
+
+    uint32_t windows;
+    uint64_t window_cycles;
+} tone;
+
+int audio_tone_setup(const audio_tone_config_t *config)
+{
+    if (config->count == 0 || config->count > AUDIO_MAX_TONES) {
+        return -EINVAL;
+    }
+
+    for (int i = 0; i < config->count; i++) {
+        if (config->freq[i] == 0 || config->freq[i] >= AUDIO_SAMPLE_RATE / 2) {
+            return -EINVAL;
+        }
+    }
+
+    tone.config = *config;
+    for (int i = 0; i < config->count; i++) {
+        tone.coeff[i] = 2.0f * cosf(2.0f * (float)M_PI * config->freq[i] / AUDIO_SAMPLE_RATE);
+    }
+
+    /* Round up, a zero persistence alarms on the first window */
+    tone.persist_windows = MAX(DIV_ROUND_UP((uint32_t)config->persist_ms * AUDIO_SAMPLE_RATE,
+                                            AUDIO_TONE_WINDOW * MSEC_PER_SEC), 1);
+
+    audio_tone_reset();
+    return 0;
+}
+
+static void window_restart(void)
+{
+    memset(tone.s1, 0, sizeof(tone.s1));
+    memset(tone.s2, 0, sizeof(tone.s2));
+    tone.energy = 0;
+    tone.fill = 0;
+}
+
+void audio_tone_reset(void)
+{
+    window_restart();
+    memset(tone.levels, 0, sizeof(tone.levels));
+    memset(tone.score, 0, sizeof(tone.score));
+    tone.alarmed = 0;
+    tone.windows = 0;
+    tone.window_cycles = 0;
+}
+
+/* Evaluate the completed window, returns tones reaching the persistence */
+static uint32_t window_finish(void)
+{
+    /* Share of the window energy, as a ratio of mean squares */
+    float total = (float)tone.energy;
+    uint32_t raised = 0;
+
+    for (int i = 0; i < tone.config.count; i++) {
+        float s1 = tone.s1[i];
+        float s2 = tone.s2[i];
+        float power = s1 * s1 + s2 * s2 - tone.coeff[i] * s1 * s2;
+
+        /* 4 * P / N^2 is the squared amplitude of a tone at the frequency */
+        float amplitude2 = 4.0f * power / ((float)AUDIO_TONE_WINDOW * AUDIO_TONE_WINDOW);
+        float level = 10.0f * log10f(amplitude2 + 1.0f);
+        bool present;
+
+        tone.levels[i] = (uint16_t)CLAMP(level * AUDIO_LEVEL_SCALE, 0.0f, (float)UINT16_MAX);
+
+        /* A sine of amplitude A has mean square A^2 / 2 */
+        present = tone.levels[i] >= tone.config.min_level &&
+                  amplitude2 * AUDIO_TONE_WINDOW * 50.0f >= total * tone.config.min_share;
+
+        if (present) {
+            tone.score[i] = MIN(tone.score[i] + 1, tone.persist_windows);
+        } else if (tone.score[i] > 0) {
+            tone.score[i]--;
+        }
+
+        if (tone.score[i] >= tone.persist_windows && !(tone.alarmed & BIT(i))) {
+            tone.alarmed |= BIT(i);
+            raised |= BIT(i);
+        } else if (tone.score[i] == 0) {
+            tone.alarmed &= ~BIT(i);
+        }
+    }
+
+    tone.windows++;
+    window_restart();
+    return raised;
+}
+
+uint32_t audio_tone_process(const int16_t *samples, size_t count, bool gap)
+{
+    uint32_t start = k_cycle_get_32();
+    uint32_t raised = 0;
+
+    if (gap) {
+        /* Do not join windows across lost samples */
+        window_restart();
+    }
+
+    while (count > 0) {
+        size_t n = MIN(count, AUDIO_TONE_WINDOW - tone.fill);
+
+        /* One second-order recursion per tone, s = x + coeff * s1 - s2 */
+        for (int i = 0; i < tone.config.count; i++) {
+            float coeff = tone.coeff[i];
+            float s1 = tone.s1[i];
+            float s2 = tone.s2[i];
+
+            for (size_t j = 0; j < n; j++) {
+                float s = samples[j] + coeff * s1 - s2;
+
+                s2 = s1;
+                s1 = s;
+            }
+            tone.s1[i] = s1;
+            tone.s2[i] = s2;
+        }
+
+        for (size_t j = 0; j < n; j++) {
+            tone.energy += (int32_t)samples[j] * samples[j];
+        }
+
+        samples += n;
+        count -= n;
+        tone.fill += n;
+        if (tone.fill == AUDIO_TONE_WINDOW) {
+            raised |= window_finish();
+        }
+    }
+
+    tone.window_cycles += k_cycle_get_32() - start;
+    return raised;
+}
+
+int audio_tone_get_levels(uint16_t *levels)
+{
+    memcpy(levels, tone.levels, tone.config.count * sizeof(uint16_t));
+    return tone.config.count;
+}
+
+void audio_tone_get_stats(audio_stats_t *stats)
+{
+    stats->tone_windows = tone.windows;
+    stats->tone_cycles_avg = tone.windows ? tone.window_cycles / tone.windows : 0;
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef AUDIO_TONE_H
+#define AUDIO_TONE_H
+
+#include <zephyr/kernel.h>
+#include "audio_app.h"
+
+/**
+ * @brief Set up the Goertzel filter bank
+ *
+ * @param config Tone frequencies and detection thresholds
+ * @return 0 on success, -EINVAL for an invalid configuration
+ */
+int audio_tone_setup(const audio_tone_config_t *config);
+
+/**
+ * @brief Clear window and persistence state for a new detection run
+ */
+void audio_tone_reset(void);
+
+/**
+ * @brief Feed captured samples
+ *
+ * Samples are split into windows of AUDIO_TONE_WINDOW samples, continued
+ * across calls.
+ *
+ * @param samples Sample buffer
+ * @param count Number of samples
+ * @param gap true if samples were lost before this buffer
+ * @return Bit mask of tones that persisted long enough to raise an alarm
+ *         in this buffer
+ */
+uint32_t audio_tone_process(const int16_t *samples, size_t count, bool gap);
+
+/**
+ * @brief Get tone levels of the last complete window
+ *
+ * @param levels Array of tone count entries to store the level of each
+ *               tone in 1/AUDIO_LEVEL_SCALE dB
+ * @return Number of tones
+ */
+int audio_tone_get_levels(uint16_t *levels);
+
+/**
+ * @brief Get window and cycle counters
+ *
+ * Fills the tone fields of the statistics.
+ *
+ * @param stats Pointer to store counters
+ */
+void audio_tone_get_stats(audio_stats_t *stats);
+
+#endif /* AUDIO_TONE_H */
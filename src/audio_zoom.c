@@ -0,0 +1,301 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <arm_math.h>
+#include <zephyr/logging/log.h>
+#include "audio_zoom.h"
+
+LOG_MODULE_REGISTER(audio_zoom, CONFIG_APP_LOG_LEVEL);
+
+/*
+ * Zoom FFT: the signal is multiplied by a complex oscillator at the
+ * centre frequency, which moves the window of interest to 0 Hz, then
+ * lowpass filtered and decimated in two stages so a small complex FFT
+ * resolves only the window. The first stage by 8 only has to keep its
+ * aliases out of the window, so it is short; the second stage sets the
+ * window edges at the lower rate, where each tap costs 8 times less.
+ */
+#define ZOOM_FACTOR   CONFIG_AUDIO_ZOOM_DECIMATION
+#define ZOOM_FACTOR1  8
+#define ZOOM_FACTOR2  (ZOOM_FACTOR / ZOOM_FACTOR1)
+#define ZOOM_RATE     (AUDIO_SAMPLE_RATE / ZOOM_FACTOR)
+#define ZOOM_FFT_SIZE CONFIG_AUDIO_ZOOM_FFT_SIZE
+
+/* Bins within 0.4 of the decimated rate either side of the centre are alias free */
+#define ZOOM_HALF MIN(ZOOM_FFT_SIZE * 2 / 5, (MAX_ZOOM_BINS - 1) / 2)
+#define ZOOM_BINS (2 * ZOOM_HALF + 1)
+
+/*
+ * Kaiser windowed sinc taps for 60 dB stopband (beta 5.65) over a
+ * transition width, both in Hz: (60 - 7.95) / (14.36 * width / rate).
+ * Stage 1 passes the window and stops from its first alias, stage 2
+ * stops from 0.6 of the decimated rate.
+ */
+#define ZOOM_TAPS(rate, width) ((5205 * (rate)) / (1436 * (width)) + 2)
+#define ZOOM_TAPS1 ZOOM_TAPS(AUDIO_SAMPLE_RATE, AUDIO_SAMPLE_RATE / ZOOM_FACTOR1 - 4 * ZOOM_RATE / 5)
+#define ZOOM_TAPS2 ZOOM_TAPS(AUDIO_SAMPLE_RATE / ZOOM_FACTOR1, ZOOM_RATE / 5)
+#define KAISER_BETA 5.65f
+
+/* Input samples mixed and filtered per call of the decimators */
+#define ZOOM_BLOCK  256
+#define ZOOM_BLOCK1 (ZOOM_BLOCK / ZOOM_FACTOR1)
+#define ZOOM_BLOCK2 (ZOOM_BLOCK / ZOOM_FACTOR)
+
+BUILD_ASSERT(ZOOM_FACTOR2 >= 2, "zoom decimation must be at least 16");
+BUILD_ASSERT(ZOOM_BLOCK % ZOOM_FACTOR == 0, "zoom block must hold whole output samples");
+
+/* Real and imaginary parts are filtered as two real signals */
+struct zoom_path {
+    arm_fir_decimate_instance_f32 stage1;
+    arm_fir_decimate_instance_f32 stage2;
+    float32_t state1[ZOOM_TAPS1 + ZOOM_BLOCK - 1];
+    float32_t state2[ZOOM_TAPS2 + ZOOM_BLOCK1 - 1];
+    float32_t mixed[ZOOM_BLOCK];
+    float32_t mid[ZOOM_BLOCK1];
+    float32_t out[ZOOM_BLOCK2];
+};
+
+static struct {
+    uint16_t center;
+    uint32_t phase;       /* Oscillator phase, 2^32 per cycle */
+    uint32_t phase_step;
+
+    float32_t coeffs1[ZOOM_TAPS1];
+    float32_t coeffs2[ZOOM_TAPS2];
+    struct zoom_path re;
+    struct zoom_path im;
+
+    arm_cfft_instance_f32 fft_instance;
+    float32_t window[ZOOM_FFT_SIZE];
+    float32_t frame[2 * ZOOM_FFT_SIZE];  /* Interleaved complex segment being assembled */
+    float32_t fft_buf[2 * ZOOM_FFT_SIZE];
+    uint16_t frame_fill;                 /* Complex samples in frame */
+    float32_t psd_sum[ZOOM_BINS];        /* Bin power sum, lowest frequency first */
+
+    float32_t gain_scale;
+    int8_t gain_offset;
+
+    uint32_t frames;
+    uint32_t blocks;
+    uint64_t cycles;
+} zoom;
+
+/* Modified Bessel function of the first kind, order 0, by its power series */
+static float32_t bessel_i0(float32_t x)
+{
+    float32_t term = 1.0f;
+    float32_t sum = 1.0f;
+
+    for (int k = 1; k < 20; k++) {
+        term *= (x / (2.0f * k)) * (x / (2.0f * k));
+        sum += term;
+    }
+
+    return sum;
+}
+
+/* Kaiser windowed sinc lowpass with unity DC gain, cutoff as a share of the input rate */
+static void lowpass_design(float32_t *coeffs, int taps, float32_t cutoff)
+{
+    const float32_t middle = (taps - 1) / 2.0f;
+    float32_t sum = 0;
+
+    for (int n = 0; n < taps; n++) {
+        float32_t x = n - middle;
+        float32_t r = x / middle;
+        float32_t sinc = (x == 0.0f) ? 2.0f * cutoff : sinf(2.0f * PI * cutoff * x) / (PI * x);
+
+        coeffs[n] = sinc * bessel_i0(KAISER_BETA * sqrtf(MAX(1.0f - r * r, 0.0f))) /
+                    bessel_i0(KAISER_BETA);
+        sum += coeffs[n];
+    }
+
+    arm_scale_f32(coeffs, 1.0f / sum, coeffs, taps);
+}
+
+/* Also clears the filter history */
+static void path_init(struct zoom_path *path)
+{
+    arm_fir_decimate_init_f32(&path->stage1, ZOOM_TAPS1, ZOOM_FACTOR1, zoom.coeffs1,
+                              path->state1, ZOOM_BLOCK);
+    arm_fir_decimate_init_f32(&path->stage2, ZOOM_TAPS2, ZOOM_FACTOR2, zoom.coeffs2,
+                              path->state2, ZOOM_BLOCK1);
+}
+
+int audio_zoom_setup(uint16_t center)
+{
+    /* Window edges must stay between 0 Hz and half the sample rate */
+    if (center < 2 * ZOOM_RATE / 5 || center + 2 * ZOOM_RATE / 5 > AUDIO_SAMPLE_RATE / 2) {
+        return -EINVAL;
+    }
+
+    zoom.center = center;
+    zoom.phase_step = (uint32_t)(((uint64_t)center << 32) / AUDIO_SAMPLE_RATE);
+    zoom.gain_offset = 0;
+    zoom.gain_scale = 1.0f;
+
+    /* Both cutoffs at half the stage output rate */
+    lowpass_design(zoom.coeffs1, ZOOM_TAPS1, 0.5f / ZOOM_FACTOR1);
+    lowpass_design(zoom.coeffs2, ZOOM_TAPS2, 0.5f / ZOOM_FACTOR2);
+
+    for (int i = 0; i < ZOOM_FFT_SIZE; i++) {
+        zoom.window[i] = 0.5f * (1.0f - cosf(2.0f * PI * i / (ZOOM_FFT_SIZE - 1)));
+    }
+    arm_cfft_init_f32(&zoom.fft_instance, ZOOM_FFT_SIZE);
+
+    audio_zoom_reset();
+
+    LOG_INF("Zoom spectrum: %u +/- %d Hz, %d bins of %d mHz, filters %d + %d taps",
+            center, 2 * ZOOM_RATE / 5, ZOOM_BINS, 1000 * ZOOM_RATE / ZOOM_FFT_SIZE,
+            ZOOM_TAPS1, ZOOM_TAPS2);
+    return 0;
+}
+
+void audio_zoom_reset(void)
+{
+    path_init(&zoom.re);
+    path_init(&zoom.im);
+    memset(zoom.psd_sum, 0, sizeof(zoom.psd_sum));
+    zoom.phase = 0;
+    zoom.frame_fill = 0;
+    zoom.frames = 0;
+    zoom.blocks = 0;
+    zoom.cycles = 0;
+}
+
+void audio_zoom_set_gain_offset(int8_t db)
+{
+    if (db != zoom.gain_offset) {
+        zoom.gain_offset = db;
+        zoom.gain_scale = powf(10.0f, -db / 10.0f);
+    }
+}
+
+/* Multiply by exp(-j * 2 * pi * center * n / rate), int16 scaled to +/-1 */
+static void mix_down(const int16_t *samples, size_t count)
+{
+    const float32_t step = 2.0f * PI * zoom.phase_step / 4294967296.0f;
+    const float32_t rot_c = cosf(step);
+    const float32_t rot_s = sinf(step);
+    /* Exact start phase per block, the rotation only runs for one block */
+    float32_t angle = 2.0f * PI * zoom.phase / 4294967296.0f;
+    float32_t c = cosf(angle) / 32768.0f;
+    float32_t s = sinf(angle) / 32768.0f;
+
+    for (size_t i = 0; i < count; i++) {
+        float32_t next_c = c * rot_c - s * rot_s;
+
+        zoom.re.mixed[i] = samples[i] * c;
+        zoom.im.mixed[i] = -samples[i] * s;
+        s = s * rot_c + c * rot_s;
+        c = next_c;
+    }
+
+    zoom.phase += zoom.phase_step * count;
+}
+
+/* Transform one segment and add its window bins to the sums */
+static void process_segment(void)
+{
+    for (int i = 0; i < ZOOM_FFT_SIZE; i++) {
+        zoom.fft_buf[2 * i] = zoom.frame[2 * i] * zoom.window[i];
+        zoom.fft_buf[2 * i + 1] = zoom.frame[2 * i + 1] * zoom.window[i];
+    }
+
+    arm_cfft_f32(&zoom.fft_instance, zoom.fft_buf, 0, 1);
+    /* Powers into the first half of the buffer, read ahead of write */
+    arm_cmplx_mag_squared_f32(zoom.fft_buf, zoom.fft_buf, ZOOM_FFT_SIZE);
+
+    /* Negative frequencies are in the upper half of the output */
+    for (int bin = 0; bin < ZOOM_BINS; bin++) {
+        int k = (bin - ZOOM_HALF + ZOOM_FFT_SIZE) % ZOOM_FFT_SIZE;
+
+        zoom.psd_sum[bin] += zoom.fft_buf[k] * zoom.gain_scale;
+    }
+
+    zoom.frames++;
+}
+
+/* Append decimated samples, 50% overlapped segments as in the band spectrum */
+static void frame_feed(size_t count)
+{
+    const uint16_t hop = ZOOM_FFT_SIZE / 2;
+
+    for (size_t i = 0; i < count; i++) {
+        zoom.frame[2 * zoom.frame_fill] = zoom.re.out[i];
+        zoom.frame[2 * zoom.frame_fill + 1] = zoom.im.out[i];
+
+        if (++zoom.frame_fill == ZOOM_FFT_SIZE) {
+            process_segment();
+            memmove(zoom.frame, &zoom.frame[2 * hop],
+                    2 * (ZOOM_FFT_SIZE - hop) * sizeof(float32_t));
+            zoom.frame_fill = ZOOM_FFT_SIZE - hop;
+        }
+    }
+}
+
+static void path_decimate(struct zoom_path *path, size_t count)
+{
+    arm_fir_decimate_f32(&path->stage1, path->mixed, path->mid, count);
+    arm_fir_decimate_f32(&path->stage2, path->mid, path->out, count / ZOOM_FACTOR1);
+}
+
+void audio_zoom_process(const int16_t *samples, size_t count, bool gap)
+{
+    uint32_t start = k_cycle_get_32();
+
+    if (gap) {
+        /* Do not join segments or filter history across lost samples */
+        path_init(&zoom.re);
+        path_init(&zoom.im);
+        zoom.frame_fill = 0;
+    }
+
+    __ASSERT_NO_MSG(count % ZOOM_FACTOR == 0);
+
+    while (count >= ZOOM_FACTOR) {
+        size_t take = MIN(count, ZOOM_BLOCK);
+
+        take -= take % ZOOM_FACTOR;
+        mix_down(samples, take);
+        path_decimate(&zoom.re, take);
+        path_decimate(&zoom.im, take);
+        frame_feed(take / ZOOM_FACTOR);
+
+        samples += take;
+        count -= take;
+    }
+
+    zoom.cycles += k_cycle_get_32() - start;
+    zoom.blocks++;
+}
+
+int audio_zoom_get(AUDIO_ZOOM_s *result)
+{
+    if (zoom.frames == 0) {
+        return -ENODATA;
+    }
+
+    result->center_freq = zoom.center;
+    result->resolution = 1000 * ZOOM_RATE / ZOOM_FFT_SIZE;
+    result->count = ZOOM_BINS;
+
+    for (int bin = 0; bin < ZOOM_BINS; bin++) {
+        /* dB relative to one int16 LSB, as the band levels */
+        float32_t power = zoom.psd_sum[bin] / zoom.frames;
+        float32_t db = MAX(10.0f * log10f(power + 1e-12f) + AUDIO_LSB_DB, 0.0f);
+
+        result->level[bin] = (uint16_t)MIN(db * AUDIO_LEVEL_SCALE, UINT16_MAX);
+    }
+
+    return ZOOM_BINS;
+}
+
+void audio_zoom_get_stats(audio_stats_t *stats)
+{
+    stats->zoom_frames = zoom.frames;
+    stats->zoom_cycles_avg = zoom.blocks ? zoom.cycles / zoom.blocks : 0;
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef AUDIO_ZOOM_H
+#define AUDIO_ZOOM_H
+
+#include <zephyr/kernel.h>
+#include "audio_app.h"
+
+/**
+ * @brief Set up the zoom spectrum around a centre frequency
+ *
+ * Designs the two decimation filters for CONFIG_AUDIO_ZOOM_DECIMATION
+ * and the window of the CONFIG_AUDIO_ZOOM_FFT_SIZE complex FFT. The
+ * analysed window spans 0.4 of the decimated rate on either side of
+ * the centre. Must not be called while a recording is processed.
+ *
+ * @param center Centre frequency in Hz
+ * @return 0 on success, -EINVAL if the window does not fit below half
+ *         the sample rate
+ */
+int audio_zoom_setup(uint16_t center);
+
+/**
+ * @brief Clear accumulated spectra for a new recording
+ */
+void audio_zoom_reset(void);
+
+/**
+ * @brief Set the capture gain to remove from the levels
+ *
+ * @param db Capture gain above the reference gain in dB
+ */
+void audio_zoom_set_gain_offset(int8_t db);
+
+/**
+ * @brief Feed captured samples at AUDIO_SAMPLE_RATE
+ *
+ * Samples are mixed down to the centre frequency, decimated and split
+ * into Hann windowed segments with 50% overlap, continued across calls.
+ *
+ * @param samples Sample buffer
+ * @param count Number of samples, a multiple of CONFIG_AUDIO_ZOOM_DECIMATION
+ * @param gap true if samples were lost before this buffer
+ */
+void audio_zoom_process(const int16_t *samples, size_t count, bool gap);
+
+/**
+ * @brief Get the zoom spectrum of the recording so far
+ *
+ * @param zoom Pointer to store centre, bin spacing and mean bin levels
+ *             in 1/AUDIO_LEVEL_SCALE dB, same reference as band levels
+ * @return Number of bins, -ENODATA if no segment was processed
+ */
+int audio_zoom_get(AUDIO_ZOOM_s *zoom);
+
+/**
+ * @brief Get zoom processing cost
+ *
+ * Fills the zoom fields of the statistics.
+ *
+ * @param stats Pointer to store counters
+ */
+void audio_zoom_get_stats(audio_stats_t *stats);
+
+#endif /* AUDIO_ZOOM_H */
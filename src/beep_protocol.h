@@ -41,6 +41,17 @@ typedef enum {
     READ_COMM_METHOD = 0x90,
     WRITE_COMM_METHOD = 0x91,
     READ_COMM_STATUS = 0x92,
+
+    /* Audio analysis configuration */
+    READ_AUDIO_CONFIG = 0xA0,
+    WRITE_AUDIO_CONFIG = 0xA1,
+    START_AUDIO_RECORD = 0xA2,
+    READ_AUDIO_FILE = 0xA3,
+    READ_AUDIO_STATS = 0xA4,
+    READ_AUDIO_TONES = 0xA5,
+    WRITE_AUDIO_TONES = 0xA6,
+    START_AUDIO_TONES = 0xA7,
+    DELETE_AUDIO_FILE = 0xA8,
 } BEEP_CID;
 
 /* Status flags - Add new flags */
@@ -17,6 +17,12 @@
 /* Maximum FFT size */
 #define MAX_FFT_SIZE 256
 
+/* Maximum number of cepstral coefficients */
+#define MAX_MFCC 20
+
+/* Maximum number of zoom spectrum bins */
+#define MAX_ZOOM_BINS 255
+
 /* Measurement source */
 typedef enum {
     INTERNAL_SOURCE,
@@ -30,6 +36,9 @@ typedef enum {
     BME280,
     HX711,
     AUDIO_ADC,
+    AUDIO_FEATURES,
+    AUDIO_MFCC,
+    AUDIO_ZOOM,
 } MEASUREMENT_TYPE_e;
 
 /* DS18B20 results */
@@ -56,9 +65,36 @@ typedef struct {
 typedef struct {
     uint16_t size;
     uint16_t frequency;
+    uint32_t timestamp;   /* Recording start */
+    uint8_t config;       /* Gain high nibble, AGC bit 3, log2(size) - 8 in bits 0-2 */
+    uint8_t band_count;   /* Band levels in magnitude, 0 for other contents */
+    uint8_t encoding;     /* audio_encoding_t of the uplink payload */
     uint16_t magnitude[MAX_FFT_SIZE];
 } FFT_RESULT_s;
 
+/* Audio spectral features over the configured band span */
+typedef struct {
+    uint16_t centroid;     /* Power weighted mean frequency in Hz */
+    uint16_t rolloff;      /* Frequency below which 85% of the power lies, in Hz */
+    uint16_t level;        /* Total power in 0.01 dB, same reference as band levels */
+    uint8_t flatness;      /* Geometric over arithmetic mean power, 0-255 for 0-1 */
+    int8_t low_high;       /* Power below over above the split frequency in 0.5 dB */
+} AUDIO_FEATURES_s;
+
+/* Audio mel-frequency cepstrum, mean over the recording */
+typedef struct {
+    uint8_t count;
+    int16_t coeff[MAX_MFCC];  /* Coefficients in 0.01 units, c0 first */
+} AUDIO_MFCC_s;
+
+/* Audio zoom spectrum around a centre frequency, mean over the recording */
+typedef struct {
+    uint16_t center_freq;          /* Frequency of the middle bin in Hz */
+    uint16_t resolution;           /* Bin spacing in mHz */
+    uint16_t count;                /* Number of entries used in level, odd */
+    uint16_t level[MAX_ZOOM_BINS]; /* Bin levels in 0.01 dB, lowest frequency first */
+} AUDIO_ZOOM_s;
+
 /* Combined measurement result */
 typedef struct {
     MEASUREMENT_TYPE_e type;
@@ -68,6 +104,9 @@ typedef struct {
         BME280_RESULT_s bme280;
         HX711_CONV_s hx711;
         FFT_RESULT_s fft;
+        AUDIO_FEATURES_s features;
+        AUDIO_MFCC_s mfcc;
+        AUDIO_ZOOM_s zoom;
     } result;
 } MEASUREMENT_RESULT_s;
 
@@ -98,13 +137,13 @@ typedef struct {
     int32_t Diff;
 } HX711_ALARM_s;
 
-/* Audio alarm thresholds */
+/* Audio alarm thresholds, relative to the band noise floor */
 typedef struct {
-    uint16_t Min;
-    uint16_t Max;
-    uint16_t Diff;
-    uint16_t FreqMin;
-    uint16_t FreqMax;
+    uint16_t Min;      /* Drop below the floor in 0.01 dB */
+    uint16_t Max;      /* Rise above the floor in 0.01 dB */
+    uint16_t Diff;     /* Spread of the band rises in 0.01 dB */
+    uint16_t FreqMin;  /* Lowest band frequency checked in Hz */
+    uint16_t FreqMax;  /* Highest band frequency checked in Hz, 0 for all */
 } AUDIO_ALARM_s;
 
 /* Combined alarm configuration */
@@ -9,6 +9,7 @@
 #include "beep_protocol.h"
 #include "rtc_app.h"
 #include "flash_fs.h"
+#include "audio_app.h"
 
 LOG_MODULE_REGISTER(ble_app, CONFIG_APP_LOG_LEVEL);
 
@@ -133,6 +134,202 @@ static int handle_system_reset(void)
     return 0;
 }
 
+/*
+ * Audio configuration, little endian: duration (4), interval (2),
+ * gain (1), AGC (1), FFT size (2), band count (1), encoding (1), then
+ * start and end frequency (2 + 2) of each band.
+ */
+#define AUDIO_CONFIG_HEADER_LEN 12
+
+static int handle_read_audio_config(uint8_t *response, uint16_t *len)
+{
+    audio_config_t config;
+    int ret = audio_app_get_config(&config);
+    if (ret < 0) {
+        return ret;
+    }
+
+    memcpy(&response[0], &config.duration, sizeof(uint32_t));
+    memcpy(&response[4], &config.interval, sizeof(uint16_t));
+    response[6] = config.gain;
+    response[7] = config.agc_enabled;
+    memcpy(&response[8], &config.fft_size, sizeof(uint16_t));
+    response[10] = config.band_count;
+    response[11] = config.encoding;
+    memcpy(&response[AUDIO_CONFIG_HEADER_LEN], config.bands,
+           config.band_count * sizeof(fft_band_config_t));
+    *len = AUDIO_CONFIG_HEADER_LEN + config.band_count * sizeof(fft_band_config_t);
+    return 0;
+}
+
+static int handle_write_audio_config(const uint8_t *data, uint16_t len)
+{
+    audio_config_t config;
+
+    if (len < AUDIO_CONFIG_HEADER_LEN || data[10] > AUDIO_MAX_BANDS ||
+        len < AUDIO_CONFIG_HEADER_LEN + data[10] * sizeof(fft_band_config_t)) {
+        return -EINVAL;
+    }
+
+    memset(&config, 0, sizeof(config));
+    memcpy(&config.duration, &data[0], sizeof(uint32_t));
+    memcpy(&config.interval, &data[4], sizeof(uint16_t));
+    config.gain = data[6];
+    config.agc_enabled = data[7] != 0;
+    memcpy(&config.fft_size, &data[8], sizeof(uint16_t));
+    config.band_count = data[10];
+    config.encoding = data[11];
+    memcpy(config.bands, &data[AUDIO_CONFIG_HEADER_LEN],
+           config.band_count * sizeof(fft_band_config_t));
+
+    return audio_app_config(&config);
+}
+
+/* Raw recording: duration in seconds (2), responds with the file index (4) */
+static int handle_start_audio_record(const uint8_t *data, uint16_t len,
+                                     uint8_t *response, uint16_t *resp_len)
+{
+    uint16_t duration;
+    uint32_t index;
+
+    if (len < sizeof(duration)) {
+        return -EINVAL;
+    }
+
+    memcpy(&duration, data, sizeof(duration));
+    int ret = audio_app_record(duration, &index);
+    if (ret == 0) {
+        memcpy(response, &index, sizeof(index));
+        *resp_len = sizeof(index);
+    }
+    return ret;
+}
+
+/*
+ * Recording download cursor: file index (4), byte offset (4), maximum
+ * length (1) and optionally the part (1), 0 for the WAV file and 1 for
+ * the triggering measurement. Responds with the offset followed by the
+ * data, an offset alone marks the end of the file.
+ */
+static int handle_read_audio_file(const uint8_t *data, uint16_t len,
+                                  uint8_t *response, uint16_t *resp_len)
+{
+    uint32_t index;
+    uint32_t offset;
+    size_t size;
+    int ret;
+
+    if (len < 9) {
+        return -EINVAL;
+    }
+
+    memcpy(&index, &data[0], sizeof(index));
+    memcpy(&offset, &data[4], sizeof(offset));
+    size = MIN(data[8], sizeof(response_buffer) - sizeof(offset));
+
+    if (len > 9 && data[9] == 1) {
+        ret = flash_fs_read_audio_trigger(index, offset, &response[sizeof(offset)], size);
+    } else if (len > 9 && data[9] != 0) {
+        return -EINVAL;
+    } else {
+        ret = flash_fs_read_audio(index, offset, &response[sizeof(offset)], size);
+    }
+    if (ret < 0) {
+        return ret;
+    }
+
+    memcpy(response, &offset, sizeof(offset));
+    *resp_len = sizeof(offset) + ret;
+    return 0;
+}
+
+/* Recording and trigger removal: file index (4) */
+static int handle_delete_audio_file(const uint8_t *data, uint16_t len)
+{
+    uint32_t index;
+
+    if (len < sizeof(index)) {
+        return -EINVAL;
+    }
+
+    memcpy(&index, data, sizeof(index));
+    return flash_fs_delete_audio(index);
+}
+
+/* Capture counters: blocks, dropped blocks, overruns, recorded bytes, write errors (4 each) */
+static int handle_read_audio_stats(uint8_t *response, uint16_t *len)
+{
+    audio_stats_t stats;
+    int ret = audio_app_get_stats(&stats);
+    if (ret < 0) {
+        return ret;
+    }
+
+    memcpy(&response[0], &stats.blocks, sizeof(uint32_t));
+    memcpy(&response[4], &stats.dropped_blocks, sizeof(uint32_t));
+    memcpy(&response[8], &stats.overruns, sizeof(uint32_t));
+    memcpy(&response[12], &stats.rec_bytes, sizeof(uint32_t));
+    memcpy(&response[16], &stats.rec_write_errors, sizeof(uint32_t));
+    *len = 20;
+    return 0;
+}
+
+/*
+ * Tone detection configuration, little endian: tone count (1), minimum
+ * energy share in percent (1), minimum level in 0.01 dB (2), persistence
+ * in ms (2), then the frequency in Hz (2) of each tone.
+ */
+#define AUDIO_TONES_HEADER_LEN 6
+
+static int handle_read_audio_tones(uint8_t *response, uint16_t *len)
+{
+    audio_tone_config_t config;
+    int ret = audio_app_get_tone_config(&config);
+    if (ret < 0) {
+        return ret;
+    }
+
+    response[0] = config.count;
+    response[1] = config.min_share;
+    memcpy(&response[2], &config.min_level, sizeof(uint16_t));
+    memcpy(&response[4], &config.persist_ms, sizeof(uint16_t));
+    memcpy(&response[AUDIO_TONES_HEADER_LEN], config.freq, config.count * sizeof(uint16_t));
+    *len = AUDIO_TONES_HEADER_LEN + config.count * sizeof(uint16_t);
+    return 0;
+}
+
+static int handle_write_audio_tones(const uint8_t *data, uint16_t len)
+{
+    audio_tone_config_t config;
+
+    if (len < AUDIO_TONES_HEADER_LEN || data[0] > AUDIO_MAX_TONES ||
+        len < AUDIO_TONES_HEADER_LEN + data[0] * sizeof(uint16_t)) {
+        return -EINVAL;
+    }
+
+    memset(&config, 0, sizeof(config));
+    config.count = data[0];
+    config.min_share = data[1];
+    memcpy(&config.min_level, &data[2], sizeof(uint16_t));
+    memcpy(&config.persist_ms, &data[4], sizeof(uint16_t));
+    memcpy(config.freq, &data[AUDIO_TONES_HEADER_LEN], config.count * sizeof(uint16_t));
+
+    return audio_app_tone_config(&config);
+}
+
+/* Tone detection run: duration in seconds (4), 0 until stopped */
+static int handle_start_audio_tones(const uint8_t *data, uint16_t len)
+{
+    uint32_t duration;
+
+    if (len < sizeof(duration)) {
+        return -EINVAL;
+    }
+
+    memcpy(&duration, data, sizeof(duration));
+    return audio_app_tone_detect(duration);
+}
+
 /* GATT write callback */
 static ssize_t ble_write_callback(struct bt_conn *conn,
                                 const struct bt_gatt_attr *attr,
@@ -185,6 +382,33 @@ static ssize_t ble_write_callback(struct bt_conn *conn,
         case SYSTEM_RESET:
             ret = handle_system_reset();
             break;
+        case READ_AUDIO_CONFIG:
+            ret = handle_read_audio_config(response_buffer, &response_len);
+            break;
+        case WRITE_AUDIO_CONFIG:
+            ret = handle_write_audio_config(data, len);
+            break;
+        case START_AUDIO_RECORD:
+            ret = handle_start_audio_record(data, len, response_buffer, &response_len);
+            break;
+        case READ_AUDIO_FILE:
+            ret = handle_read_audio_file(data, len, response_buffer, &response_len);
+            break;
+        case READ_AUDIO_STATS:
+            ret = handle_read_audio_stats(response_buffer, &response_len);
+            break;
+        case READ_AUDIO_TONES:
+            ret = handle_read_audio_tones(response_buffer, &response_len);
+            break;
+        case WRITE_AUDIO_TONES:
+            ret = handle_write_audio_tones(data, len);
+            break;
+        case START_AUDIO_TONES:
+            ret = handle_start_audio_tones(data, len);
+            break;
+        case DELETE_AUDIO_FILE:
+            ret = handle_delete_audio_file(data, len);
+            break;
         default:
             if (callbacks && callbacks->control) {
                 callbacks->control(cmd, data, len);
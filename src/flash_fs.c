@@ -3,12 +3,16 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <string.h>
 #include <zephyr/kernel.h>
 #include <zephyr/fs/fs.h>
 #include <zephyr/fs/littlefs.h>
 #include <zephyr/storage/flash_map.h>
 #include <zephyr/logging/log.h>
 #include "flash_fs.h"
+#if defined(CONFIG_MX25_FLASH)
+#include "mx_flash.h"
+#endif
 
 LOG_MODULE_REGISTER(flash_fs, CONFIG_APP_LOG_LEVEL);
 
@@ -26,6 +30,25 @@ static struct fs_mount_t fs_mnt = {
 /* Mutex for filesystem access */
 K_MUTEX_DEFINE(fs_mutex);
 
+/*
+ * Measurement dumps and audio downloads over BLE read in bulk. Their
+ * thread is marked so the driver runs its reads in the background,
+ * behind the metadata reads of other flash users.
+ */
+static void bulk_read_begin(void)
+{
+#if defined(CONFIG_MX25_FLASH)
+    mx_flash_read_background_set(DEVICE_DT_GET(PARTITION_NODE), true);
+#endif
+}
+
+static void bulk_read_end(void)
+{
+#if defined(CONFIG_MX25_FLASH)
+    mx_flash_read_background_set(DEVICE_DT_GET(PARTITION_NODE), false);
+#endif
+}
+
 /* Internal functions */
 static int ensure_directory(const char *path)
 {
@@ -97,6 +120,11 @@ int flash_fs_init(void)
         return ret;
     }
 
+    ret = ensure_directory(FLASH_FS_MOUNT_POINT "/audio");
+    if (ret < 0) {
+        return ret;
+    }
+
     LOG_INF("Flash filesystem initialized");
     return 0;
 }
@@ -151,7 +179,9 @@ int flash_fs_read_measurement(uint32_t index, MEASUREMENT_RESULT_s *result)
     }
 
     /* Read measurement data */
+    bulk_read_begin();
     ret = fs_read(&file, result, sizeof(MEASUREMENT_RESULT_s));
+    bulk_read_end();
     fs_close(&file);
 
     k_mutex_unlock(&fs_mutex);
@@ -233,6 +263,208 @@ int flash_fs_clear_measurements(void)
     return 0;
 }
 
+int flash_fs_audio_create(struct fs_file_t *file, uint32_t *index)
+{
+    char path[FLASH_FS_MAX_FILENAME];
+    int ret;
+
+    k_mutex_lock(&fs_mutex, K_FOREVER);
+
+    ret = get_next_index(FLASH_FS_MOUNT_POINT "/audio", index);
+    if (ret < 0) {
+        k_mutex_unlock(&fs_mutex);
+        return ret;
+    }
+
+    snprintf(path, sizeof(path), FLASH_FS_MOUNT_POINT "/audio/%u.wav", *index);
+    fs_file_t_init(file);
+    ret = fs_open(file, path, FS_O_CREATE | FS_O_WRITE);
+    if (ret < 0) {
+        LOG_ERR("Failed to create audio file: %d", ret);
+    }
+
+    k_mutex_unlock(&fs_mutex);
+    return ret;
+}
+
+int flash_fs_audio_write(struct fs_file_t *file, const void *data, size_t size)
+{
+    ssize_t ret;
+
+    /* Lock per write, other files stay accessible during a recording */
+    k_mutex_lock(&fs_mutex, K_FOREVER);
+    ret = fs_write(file, data, size);
+    k_mutex_unlock(&fs_mutex);
+
+    if (ret < 0) {
+        return ret;
+    }
+    return (ret == size) ? 0 : -ENOSPC;
+}
+
+int flash_fs_audio_finish(struct fs_file_t *file, const void *header, size_t size)
+{
+    int ret;
+
+    k_mutex_lock(&fs_mutex, K_FOREVER);
+
+    ret = fs_seek(file, 0, FS_SEEK_SET);
+    if (ret == 0) {
+        ret = fs_write(file, header, size);
+    }
+    fs_close(file);
+
+    k_mutex_unlock(&fs_mutex);
+    return ret < 0 ? ret : 0;
+}
+
+/* Read part of "/audio/<index>.<ext>" */
+static int read_audio_part(uint32_t index, const char *ext, uint32_t offset,
+                           void *data, size_t size)
+{
+    char path[FLASH_FS_MAX_FILENAME];
+    struct fs_file_t file;
+    int ret;
+
+    k_mutex_lock(&fs_mutex, K_FOREVER);
+
+    snprintf(path, sizeof(path), FLASH_FS_MOUNT_POINT "/audio/%u.%s", index, ext);
+    fs_file_t_init(&file);
+    ret = fs_open(&file, path, FS_O_READ);
+    if (ret < 0) {
+        k_mutex_unlock(&fs_mutex);
+        return ret;
+    }
+
+    ret = fs_seek(&file, offset, FS_SEEK_SET);
+    if (ret == 0) {
+        bulk_read_begin();
+        ret = fs_read(&file, data, size);
+        bulk_read_end();
+    }
+    fs_close(&file);
+
+    k_mutex_unlock(&fs_mutex);
+    return ret;
+}
+
+int flash_fs_read_audio(uint32_t index, uint32_t offset, void *data, size_t size)
+{
+    return read_audio_part(index, "wav", offset, data, size);
+}
+
+int flash_fs_store_audio_trigger(uint32_t index, const MEASUREMENT_RESULT_s *result)
+{
+    char path[FLASH_FS_MAX_FILENAME];
+    struct fs_file_t file;
+    ssize_t ret;
+
+    if (!result) {
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&fs_mutex, K_FOREVER);
+
+    snprintf(path, sizeof(path), FLASH_FS_MOUNT_POINT "/audio/%u.trg", index);
+    fs_file_t_init(&file);
+    ret = fs_open(&file, path, FS_O_CREATE | FS_O_WRITE);
+    if (ret < 0) {
+        LOG_ERR("Failed to create audio trigger file: %d", (int)ret);
+        k_mutex_unlock(&fs_mutex);
+        return ret;
+    }
+
+    ret = fs_write(&file, result, sizeof(MEASUREMENT_RESULT_s));
+    fs_close(&file);
+
+    k_mutex_unlock(&fs_mutex);
+    if (ret < 0) {
+        return ret;
+    }
+    return (ret == sizeof(MEASUREMENT_RESULT_s)) ? 0 : -ENOSPC;
+}
+
+int flash_fs_read_audio_trigger(uint32_t index, uint32_t offset, void *data, size_t size)
+{
+    return read_audio_part(index, "trg", offset, data, size);
+}
+
+/* Remove a recording and its trigger, the caller holds fs_mutex */
+static int delete_audio(uint32_t index)
+{
+    char path[FLASH_FS_MAX_FILENAME];
+    int ret;
+
+    snprintf(path, sizeof(path), FLASH_FS_MOUNT_POINT "/audio/%u.wav", index);
+    ret = fs_unlink(path);
+    if (ret < 0) {
+        return ret;
+    }
+
+    /* Manual recordings have no trigger */
+    snprintf(path, sizeof(path), FLASH_FS_MOUNT_POINT "/audio/%u.trg", index);
+    ret = fs_unlink(path);
+    return (ret == -ENOENT) ? 0 : ret;
+}
+
+int flash_fs_delete_audio(uint32_t index)
+{
+    int ret;
+
+    k_mutex_lock(&fs_mutex, K_FOREVER);
+    ret = delete_audio(index);
+    k_mutex_unlock(&fs_mutex);
+    return ret;
+}
+
+int flash_fs_audio_rotate(uint32_t max_files)
+{
+    struct fs_dir_t dir;
+    struct fs_dirent entry;
+    int ret;
+
+    if (max_files == 0) {
+        return -EINVAL;
+    }
+
+    k_mutex_lock(&fs_mutex, K_FOREVER);
+
+    do {
+        uint32_t count = 0;
+        uint32_t oldest = UINT32_MAX;
+
+        fs_dir_t_init(&dir);
+        ret = fs_opendir(&dir, FLASH_FS_MOUNT_POINT "/audio");
+        if (ret < 0) {
+            break;
+        }
+
+        while (fs_readdir(&dir, &entry) == 0) {
+            if (entry.name[0] == 0) {
+                break;
+            }
+            uint32_t current_index;
+            char ext[4];
+            if (sscanf(entry.name, "%u.%3s", &current_index, ext) == 2 &&
+                strcmp(ext, "wav") == 0) {
+                count++;
+                oldest = MIN(oldest, current_index);
+            }
+        }
+        fs_closedir(&dir);
+
+        if (count < max_files) {
+            break;
+        }
+
+        LOG_INF("Deleting audio recording %u, %u stored", oldest, count);
+        ret = delete_audio(oldest);
+    } while (ret == 0);
+
+    k_mutex_unlock(&fs_mutex);
+    return ret;
+}
+
 int flash_fs_store_config(const void *data, size_t size)
 {
     struct fs_file_t file;
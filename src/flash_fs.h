@@ -73,6 +73,94 @@ int flash_fs_delete_measurement(uint32_t index);
  */
 int flash_fs_clear_measurements(void);
 
+/**
+ * @brief Create the next audio recording file
+ *
+ * Creates FLASH_FS_MOUNT_POINT "/audio/<index>.wav". The file stays open
+ * for flash_fs_audio_write() until flash_fs_audio_finish().
+ *
+ * @param file File handle to open
+ * @param index Pointer to store the recording index
+ * @return 0 on success, negative errno code on failure
+ */
+int flash_fs_audio_create(struct fs_file_t *file, uint32_t *index);
+
+/**
+ * @brief Append data to an open audio recording
+ *
+ * @param file File handle from flash_fs_audio_create()
+ * @param data Data to append
+ * @param size Number of bytes
+ * @return 0 on success, negative errno code on failure
+ */
+int flash_fs_audio_write(struct fs_file_t *file, const void *data, size_t size);
+
+/**
+ * @brief Rewrite the file header and close an audio recording
+ *
+ * @param file File handle from flash_fs_audio_create()
+ * @param header Final header, replacing the first bytes of the file
+ * @param size Header size
+ * @return 0 on success, negative errno code on failure
+ */
+int flash_fs_audio_finish(struct fs_file_t *file, const void *header, size_t size);
+
+/**
+ * @brief Read part of an audio recording
+ *
+ * @param index Recording index
+ * @param offset Byte offset in the file
+ * @param data Buffer to store data
+ * @param size Buffer size
+ * @return Number of bytes read, 0 at end of file, negative errno code on failure
+ */
+int flash_fs_read_audio(uint32_t index, uint32_t offset, void *data, size_t size);
+
+/**
+ * @brief Store the measurement that triggered an audio recording
+ *
+ * Written next to the recording as FLASH_FS_MOUNT_POINT "/audio/<index>.trg".
+ *
+ * @param index Recording index
+ * @param result Triggering measurement
+ * @return 0 on success, negative errno code on failure
+ */
+int flash_fs_store_audio_trigger(uint32_t index, const MEASUREMENT_RESULT_s *result);
+
+/**
+ * @brief Read part of the measurement that triggered an audio recording
+ *
+ * The file holds one MEASUREMENT_RESULT_s as stored by
+ * flash_fs_store_audio_trigger().
+ *
+ * @param index Recording index
+ * @param offset Byte offset in the file
+ * @param data Buffer to store data
+ * @param size Buffer size
+ * @return Number of bytes read, 0 at end of file, -ENOENT if the
+ *         recording has no trigger, other negative errno code on failure
+ */
+int flash_fs_read_audio_trigger(uint32_t index, uint32_t offset, void *data, size_t size);
+
+/**
+ * @brief Delete an audio recording and its trigger measurement
+ *
+ * @param index Recording index
+ * @return 0 on success, -ENOENT if the recording does not exist, other
+ *         negative errno code on failure
+ */
+int flash_fs_delete_audio(uint32_t index);
+
+/**
+ * @brief Delete the oldest audio recordings until fewer than max_files remain
+ *
+ * Makes room for the next recording, lowest index first.
+ *
+ * @param max_files Number of recordings to keep including the next one
+ * @return 0 on success, -EINVAL if max_files is 0, negative errno code on failure
+ */
+int flash_fs_audio_rotate(uint32_t max_files);
+
 /**
  * @brief Store configuration data in flash
  *
@@ -7,6 +7,7 @@
 #include <zephyr/lorawan/lorawan.h>
 #include <zephyr/logging/log.h>
 #include "lorawan_app.h"
+#include "audio_app.h"
 
 LOG_MODULE_REGISTER(lorawan_app, CONFIG_LOG_DEFAULT_LEVEL);
 
@@ -88,43 +89,97 @@ static void join_retry_handler(struct k_work *work)
     }
 }
 
+/* Payload encoding happens here, results travel as MEASUREMENT_RESULT_s up to this point */
 static int encode_measurement(const MEASUREMENT_RESULT_s *result, uint8_t *buffer, size_t *size)
 {
-    if (*size < sizeof(MEASUREMENT_RESULT_s)) {
-        return -ENOSPC;
-    }
+    const void *data;
+    size_t len;
 
     /* Add message type */
     buffer[0] = result->type;
-    uint8_t offset = 1;
+    size_t offset = 1;
 
     /* Encode measurement data based on type */
     switch (result->type) {
     case DS18B20:
-        memcpy(&buffer[offset], &result->result.ds18B20, sizeof(result->result.ds18B20));
-        offset += sizeof(result->result.ds18B20);
+        data = &result->result.ds18B20;
+        len = sizeof(result->result.ds18B20);
         break;
 
     case BME280:
-        memcpy(&buffer[offset], &result->result.bme280, sizeof(result->result.bme280));
-        offset += sizeof(result->result.bme280);
+        data = &result->result.bme280;
+        len = sizeof(result->result.bme280);
         break;
 
     case HX711:
-        memcpy(&buffer[offset], &result->result.hx711, sizeof(result->result.hx711));
-        offset += sizeof(result->result.hx711);
+        data = &result->result.hx711;
+        len = sizeof(result->result.hx711);
         break;
 
     case AUDIO_ADC:
-        memcpy(&buffer[offset], &result->result.fft, sizeof(result->result.fft));
-        offset += sizeof(result->result.fft);
+        if (result->result.fft.band_count > 0) {
+            /* Band levels in the configured uplink encoding */
+            uint8_t payload_size;
+            int ret;
+
+            if (*size < offset + FFT_MAX_PAYLOAD) {
+                return -ENOSPC;
+            }
+            ret = audio_app_encode_fft(&result->result.fft, &buffer[offset], &payload_size);
+            if (ret < 0) {
+                return ret;
+            }
+            *size = offset + payload_size;
+            return 0;
+        }
+        /* Tone levels: count, alarmed frequency and one level per tone */
+        data = &result->result.fft;
+        len = offsetof(FFT_RESULT_s, timestamp);
+        if (*size < offset + len + result->result.fft.size * sizeof(uint16_t)) {
+            return -ENOSPC;
+        }
+        memcpy(&buffer[offset], data, len);
+        offset += len;
+        data = result->result.fft.magnitude;
+        len = result->result.fft.size * sizeof(uint16_t);
+        break;
+
+    case AUDIO_FEATURES:
+        data = &result->result.features;
+        len = sizeof(result->result.features);
+        break;
+
+    case AUDIO_MFCC:
+        data = &result->result.mfcc;
+        len = offsetof(AUDIO_MFCC_s, coeff) + result->result.mfcc.count * sizeof(int16_t);
         break;
 
+    case AUDIO_ZOOM: {
+        /* Middle bins in DB8, as the full spectrum exceeds one uplink */
+        uint8_t payload_size;
+        int ret;
+
+        if (*size < offset + FFT_MAX_PAYLOAD) {
+            return -ENOSPC;
+        }
+        ret = audio_app_encode_zoom(&result->result.zoom, &buffer[offset], &payload_size);
+        if (ret < 0) {
+            return ret;
+        }
+        *size = offset + payload_size;
+        return 0;
+    }
+
     default:
         return -EINVAL;
     }
 
-    *size = offset;
+    if (*size < offset + len) {
+        return -ENOSPC;
+    }
+    memcpy(&buffer[offset], data, len);
+
+    *size = offset + len;
     return 0;
 }
 
@@ -1,5 +1,6 @@
 /* Previous includes remain */
 #include "comm_mgr.h"
+#include "measurement_pool.h"
 
 /* Previous thread and configuration definitions remain */
 
@@ -13,21 +14,44 @@ static const COMM_CONFIG_s comm_config = {
 
 /* Previous thread implementations remain */
 
+/* Queue measurements by reference, results on the caller's stack are copied once */
+static void measurement_handler(const MEASUREMENT_RESULT_s *result)
+{
+    MEASUREMENT_RESULT_s *pooled;
+
+    if (measurement_pool_owns(result)) {
+        pooled = (MEASUREMENT_RESULT_s *)result;
+    } else {
+        pooled = measurement_pool_alloc(result->type);
+        if (!pooled) {
+            LOG_WRN("Measurement pool empty, type %d dropped", result->type);
+            return;
+        }
+        memcpy(pooled, result, sizeof(*pooled));
+    }
+
+    /* Thresholds are checked before the result leaves for the transport */
+    alarm_app_process(pooled);
+    measurement_pool_put(pooled);
+}
+
 /* Update data thread to use communication manager */
 static void data_thread(void *p1, void *p2, void *p3)
 {
-    MEASUREMENT_RESULT_s result;
+    MEASUREMENT_RESULT_s *result;
     COMM_STATUS_s comm_status;
     int ret;
 
     while (1) {
-        /* Wait for measurement data */
-        if (k_msgq_get(&measurement_msgq, &result, K_FOREVER) == 0) {
+        /* Wait for measurement data, encoded for the link when sent */
+        result = measurement_pool_get(K_FOREVER);
+        if (result) {
             /* Try to send measurement */
-            ret = comm_mgr_send_measurement(&result);
+            ret = comm_mgr_send_measurement(result);
             if (ret < 0 && ret != -EAGAIN) {
                 LOG_ERR("Failed to send measurement: %d", ret);
             }
+            measurement_pool_free(result);
 
             /* Get communication status for debugging */
             if (comm_mgr_get_status(&comm_status) == 0) {
@@ -147,6 +171,13 @@ int main(void)
         return ret;
     }
 
+    /* Initialize measurement result pool */
+    ret = measurement_pool_init();
+    if (ret < 0) {
+        LOG_ERR("Failed to initialize measurement pool: %d", ret);
+        return ret;
+    }
+
     /* Initialize flash filesystem */
     ret = flash_fs_init();
     if (ret < 0) {
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/logging/log.h>
+#include "measurement_pool.h"
+
+LOG_MODULE_REGISTER(measurement_pool, CONFIG_APP_LOG_LEVEL);
+
+/*
+ * Results are written once by the producer into a pool buffer, and
+ * only the pointer travels to the data thread, which encodes for the
+ * transport and frees it. The queue has a slot for every buffer, so
+ * putting never waits.
+ */
+#define POOL_BLOCK_SIZE ROUND_UP(sizeof(MEASUREMENT_RESULT_s), 4)
+
+static char __aligned(4) pool_buffer[CONFIG_MEASUREMENT_POOL_COUNT * POOL_BLOCK_SIZE];
+static struct k_mem_slab measurement_slab;
+K_MSGQ_DEFINE(measurement_ref_msgq, sizeof(MEASUREMENT_RESULT_s *),
+              CONFIG_MEASUREMENT_POOL_COUNT, 4);
+
+static atomic_t in_use;
+static atomic_t in_use_max;
+static atomic_t alloc_failures;
+
+int measurement_pool_init(void)
+{
+    return k_mem_slab_init(&measurement_slab, pool_buffer, POOL_BLOCK_SIZE,
+                           CONFIG_MEASUREMENT_POOL_COUNT);
+}
+
+MEASUREMENT_RESULT_s *measurement_pool_alloc(MEASUREMENT_TYPE_e type)
+{
+    MEASUREMENT_RESULT_s *result;
+
+    if (k_mem_slab_alloc(&measurement_slab, (void **)&result, K_NO_WAIT) < 0) {
+        atomic_inc(&alloc_failures);
+        return NULL;
+    }
+
+    atomic_val_t used = atomic_inc(&in_use) + 1;
+    atomic_val_t max = atomic_get(&in_use_max);
+
+    while (used > max && !atomic_cas(&in_use_max, max, used)) {
+        max = atomic_get(&in_use_max);
+    }
+
+    result->type = type;
+    result->source = INTERNAL_SOURCE;
+    return result;
+}
+
+void measurement_pool_free(MEASUREMENT_RESULT_s *result)
+{
+    if (result) {
+        void *mem = result;
+
+        __ASSERT_NO_MSG(measurement_pool_owns(result));
+        k_mem_slab_free(&measurement_slab, &mem);
+        atomic_dec(&in_use);
+    }
+}
+
+bool measurement_pool_owns(const MEASUREMENT_RESULT_s *result)
+{
+    const char *p = (const char *)result;
+
+    return p >= pool_buffer && p < &pool_buffer[sizeof(pool_buffer)];
+}
+
+int measurement_pool_put(MEASUREMENT_RESULT_s *result)
+{
+    if (k_msgq_put(&measurement_ref_msgq, &result, K_NO_WAIT) < 0) {
+        LOG_WRN("Measurement queue full, type %d dropped", result->type);
+        measurement_pool_free(result);
+        return -ENOMSG;
+    }
+
+    return 0;
+}
+
+MEASUREMENT_RESULT_s *measurement_pool_get(k_timeout_t timeout)
+{
+    MEASUREMENT_RESULT_s *result;
+
+    if (k_msgq_get(&measurement_ref_msgq, &result, timeout) < 0) {
+        return NULL;
+    }
+
+    return result;
+}
+
+void measurement_pool_get_stats(measurement_pool_stats_t *stats)
+{
+    stats->in_use = atomic_get(&in_use);
+    stats->in_use_max = atomic_get(&in_use_max);
+    stats->alloc_failures = atomic_get(&alloc_failures);
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef MEASUREMENT_POOL_H
+#define MEASUREMENT_POOL_H
+
+#include <zephyr/kernel.h>
+#include "beep_types.h"
+
+/* Pool statistics */
+typedef struct {
+    uint32_t in_use;         /* Buffers allocated or queued now */
+    uint32_t in_use_max;     /* Most buffers in use at once */
+    uint32_t alloc_failures; /* Allocations with every buffer in use */
+} measurement_pool_stats_t;
+
+/**
+ * @brief Initialize the result pool and its queue
+ *
+ * @return 0 on success, negative errno code on failure
+ */
+int measurement_pool_init(void);
+
+/**
+ * @brief Take a result buffer from the pool
+ *
+ * Only the type and source are set, producers fill the part of the
+ * result they use in place. The buffer is returned with
+ * measurement_pool_free() or handed on with measurement_pool_put().
+ *
+ * @param type Measurement type
+ * @return Result buffer, NULL if all CONFIG_MEASUREMENT_POOL_COUNT are in use
+ */
+MEASUREMENT_RESULT_s *measurement_pool_alloc(MEASUREMENT_TYPE_e type);
+
+/**
+ * @brief Return a result buffer to the pool
+ *
+ * @param result Buffer from measurement_pool_alloc()
+ */
+void measurement_pool_free(MEASUREMENT_RESULT_s *result);
+
+/**
+ * @brief Check whether a result lives in the pool
+ *
+ * @param result Measurement result
+ * @return true if the result is a pool buffer
+ */
+bool measurement_pool_owns(const MEASUREMENT_RESULT_s *result);
+
+/**
+ * @brief Queue a result for transmission by reference
+ *
+ * Ownership passes to the queue, the buffer is freed if it cannot be
+ * queued.
+ *
+ * @param result Buffer from measurement_pool_alloc()
+ * @return 0 on success, -ENOMSG if the queue is full
+ */
+int measurement_pool_put(MEASUREMENT_RESULT_s *result);
+
+/**
+ * @brief Take the next queued result
+ *
+ * The caller owns the buffer and frees it when done.
+ *
+ * @param timeout Time to wait for a result
+ * @return Result buffer, NULL on timeout
+ */
+MEASUREMENT_RESULT_s *measurement_pool_get(k_timeout_t timeout);
+
+/**
+ * @brief Get pool usage
+ *
+ * @param stats Pointer to store counters
+ */
+void measurement_pool_get_stats(measurement_pool_stats_t *stats);
+
+#endif /* MEASUREMENT_POOL_H */
@@ -0,0 +1,333 @@
+/*
+ * Copyright (c) 2023 Nordic Semiconductor ASA
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/drivers/spi.h>
+#include "mx_flash.h"
+#include "mx_flash_emul.h"
+
+#define FLASH_NODE DT_NODELABEL(mx25_flash)
+
+/* Each test works in its own 64 KB block, away from the others' cached pages */
+#define ERASE_TEST_BASE   0x000000
+#define PROGRAM_TEST_BASE 0x100000
+#define CACHE_TEST_BASE   0x200000
+#define CHUNK_TEST_BASE   0x300000
+
+static const struct device *const flash_dev = DEVICE_DT_GET(FLASH_NODE);
+static const struct emul *const flash_emul = EMUL_DT_GET(FLASH_NODE);
+
+static uint8_t *emul_mem(void)
+{
+    return mx_flash_emul_get_mem(flash_emul, NULL);
+}
+
+static bool mem_is(uint32_t offset, size_t len, uint8_t value)
+{
+    const uint8_t *mem = emul_mem();
+
+    for (size_t i = 0; i < len; i++) {
+        if (mem[offset + i] != value) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/* Page program straight on the bus, bypassing the driver's page split */
+static void raw_program(uint32_t addr, const uint8_t *data, size_t len)
+{
+    const struct mx_flash_config *config = flash_dev->config;
+    uint8_t wren = MX25_CMD_WRITE_ENABLE;
+    uint8_t cmd[4] = {MX25_CMD_PAGE_PROGRAM,
+                      (addr >> 16) & 0xFF,
+                      (addr >> 8) & 0xFF,
+                      addr & 0xFF};
+    struct spi_buf wren_buf = {.buf = &wren, .len = 1};
+    struct spi_buf prog_buf[] = {
+        {.buf = cmd, .len = sizeof(cmd)},
+        {.buf = (void *)data, .len = len},
+    };
+    const struct spi_buf_set wren_set = {.buffers = &wren_buf, .count = 1};
+    const struct spi_buf_set prog_set = {.buffers = prog_buf, .count = 2};
+
+    zassert_ok(spi_write_dt(&config->spi, &wren_set));
+    zassert_ok(spi_write_dt(&config->spi, &prog_set));
+}
+
+ZTEST(mx_flash, test_sfdp_geometry)
+{
+    const struct mx_flash_data *data = flash_dev->data;
+    const struct flash_pages_layout *layout;
+    size_t layout_size;
+
+    /* Table built by the emulator for an MX25R6435F */
+    zassert_equal(data->size, 8 * 1024 * 1024);
+    zassert_equal(data->page_size, 256);
+    zassert_equal(data->program_typ_us, 14 * 64);
+
+    zassert_equal(data->erase_types[0].size, MX25_SECTOR_SIZE);
+    zassert_equal(data->erase_types[0].opcode, MX25_CMD_SECTOR_ERASE);
+    zassert_equal(data->erase_types[0].typ_ms, 3 * 16);
+    zassert_equal(data->erase_types[0].max_ms, 6 * 3 * 16);
+    zassert_equal(data->erase_types[1].size, MX25_BLOCK_SIZE_32K);
+    zassert_equal(data->erase_types[1].opcode, MX25_CMD_BLOCK_ERASE_32K);
+    zassert_equal(data->erase_types[1].typ_ms, 13 * 16);
+    zassert_equal(data->erase_types[2].size, MX25_BLOCK_SIZE_64K);
+    zassert_equal(data->erase_types[2].opcode, MX25_CMD_BLOCK_ERASE_64K);
+    zassert_equal(data->erase_types[2].typ_ms, 25 * 16);
+    zassert_equal(data->erase_types[3].size, 0);
+
+    mx_flash_page_layout(flash_dev, &layout, &layout_size);
+    zassert_equal(layout_size, 1);
+    zassert_equal(layout->pages_size, MX25_SECTOR_SIZE);
+    zassert_equal(layout->pages_count, 2048);
+}
+
+ZTEST(mx_flash, test_erase_planner)
+{
+    struct mx_flash_emul_stats stats;
+    uint32_t start = ERASE_TEST_BASE + 0xF000;
+    size_t size = 0x22000;
+
+    memset(&emul_mem()[ERASE_TEST_BASE], 0x00, 0x40000);
+
+    /* 4 KB up to the block boundary, two 64 KB blocks, then 4 KB */
+    zassert_ok(flash_erase(flash_dev, start, size));
+
+    mx_flash_emul_stats_get(flash_emul, &stats);
+    zassert_equal(stats.sector_erases, 2);
+    zassert_equal(stats.block_erases, 2);
+    zassert_equal(stats.rejected, 0);
+
+    zassert_true(mem_is(start, size, 0xFF));
+    zassert_true(mem_is(start - 1, 1, 0x00));
+    zassert_true(mem_is(start + size, 1, 0x00));
+
+    /* Not aligned to the smallest erase unit */
+    zassert_equal(flash_erase(flash_dev, start + 1, MX25_SECTOR_SIZE), -EINVAL);
+    zassert_equal(flash_erase(flash_dev, start, MX25_SECTOR_SIZE + 1), -EINVAL);
+}
+
+ZTEST(mx_flash, test_program_page_wrap)
+{
+    struct mx_flash_emul_stats stats;
+    uint8_t buf[300];
+    uint32_t page = PROGRAM_TEST_BASE;
+    const uint8_t *mem = emul_mem();
+
+    zassert_ok(flash_erase(flash_dev, PROGRAM_TEST_BASE, MX25_SECTOR_SIZE));
+    mx_flash_emul_stats_reset(flash_emul);
+
+    for (size_t i = 0; i < sizeof(buf); i++) {
+        buf[i] = i;
+    }
+
+    /* The driver splits a write crossing a page boundary */
+    zassert_ok(flash_write(flash_dev, page + 200, buf, sizeof(buf)));
+
+    mx_flash_emul_stats_get(flash_emul, &stats);
+    zassert_equal(stats.programs, 2);
+    zassert_equal(stats.program_bytes, sizeof(buf));
+    zassert_equal(stats.rejected, 0);
+    zassert_mem_equal(&mem[page + 200], buf, sizeof(buf));
+
+    /* The chip wraps a single program within its page */
+    mx_flash_emul_timing_set(flash_emul, false);
+    raw_program(page + 0x400 + 250, buf, 10);
+    mx_flash_emul_timing_set(flash_emul, true);
+
+    zassert_mem_equal(&mem[page + 0x400 + 250], &buf[0], 6);
+    zassert_mem_equal(&mem[page + 0x400], &buf[6], 4);
+    zassert_true(mem_is(page + 0x500, 1, 0xFF));
+
+    /* Programming only clears bits */
+    uint8_t first = 0xF0;
+    uint8_t second = 0x3C;
+
+    zassert_ok(flash_write(flash_dev, page + 0x800, &first, 1));
+    zassert_ok(flash_write(flash_dev, page + 0x800, &second, 1));
+    zassert_equal(mem[page + 0x800], 0x30);
+}
+
+ZTEST(mx_flash, test_read_cache)
+{
+    struct mx_flash_cache_stats cache;
+    struct mx_flash_emul_stats stats;
+    uint8_t buf[16];
+    uint8_t bulk[2 * MX25_PAGE_SIZE];
+    uint8_t value = 0x5A;
+    uint32_t offset = CACHE_TEST_BASE + 0x10;
+
+    zassert_ok(flash_erase(flash_dev, CACHE_TEST_BASE, MX25_SECTOR_SIZE));
+    mx_flash_cache_stats_reset(flash_dev);
+    mx_flash_emul_stats_reset(flash_emul);
+
+    /* First read fills the page, the second is served from RAM */
+    zassert_ok(flash_read(flash_dev, offset, buf, sizeof(buf)));
+    zassert_ok(flash_read(flash_dev, offset, buf, sizeof(buf)));
+
+    zassert_ok(mx_flash_cache_stats_get(flash_dev, &cache));
+    zassert_equal(cache.misses, 1);
+    zassert_equal(cache.hits, 1);
+    mx_flash_emul_stats_get(flash_emul, &stats);
+    zassert_equal(stats.reads, 1);
+    zassert_equal(stats.read_bytes, MX25_PAGE_SIZE);
+
+    /* Programming the page drops it, the next read sees the new data */
+    zassert_ok(flash_write(flash_dev, offset, &value, 1));
+    zassert_ok(flash_read(flash_dev, offset, buf, sizeof(buf)));
+
+    zassert_ok(mx_flash_cache_stats_get(flash_dev, &cache));
+    zassert_equal(cache.invalidations, 1);
+    zassert_equal(cache.misses, 2);
+    zassert_equal(buf[0], value);
+    zassert_equal(buf[1], 0xFF);
+
+    /* Reads larger than a page bypass the cache */
+    zassert_ok(flash_read(flash_dev, CACHE_TEST_BASE, bulk, sizeof(bulk)));
+
+    zassert_ok(mx_flash_cache_stats_get(flash_dev, &cache));
+    zassert_equal(cache.hits + cache.misses, 3);
+    zassert_equal(bulk[0x10], value);
+
+    /* Erasing the page drops it as well */
+    zassert_ok(flash_erase(flash_dev, CACHE_TEST_BASE, MX25_SECTOR_SIZE));
+    zassert_ok(flash_read(flash_dev, offset, buf, sizeof(buf)));
+    zassert_equal(buf[0], 0xFF);
+}
+
+/* Known contents for the chunked read tests, spanning several chunks */
+static uint8_t pattern[3000];
+static uint8_t bulk[sizeof(pattern)];
+
+static void pattern_program(void)
+{
+    for (size_t i = 0; i < sizeof(pattern); i++) {
+        pattern[i] = i * 7 + 3;
+    }
+
+    zassert_ok(flash_erase(flash_dev, CHUNK_TEST_BASE, MX25_SECTOR_SIZE));
+    zassert_ok(flash_write(flash_dev, CHUNK_TEST_BASE, pattern, sizeof(pattern)));
+    memset(bulk, 0, sizeof(bulk));
+}
+
+ZTEST(mx_flash, test_read_chunks)
+{
+    const struct mx_flash_data *data = flash_dev->data;
+    struct mx_flash_lock_stats lock;
+
+    pattern_program();
+    mx_flash_lock_stats_reset(flash_dev);
+
+    /* A marked thread reads in the background, in bounded chunks */
+    mx_flash_read_background_set(flash_dev, true);
+    zassert_equal(data->background_thread, k_current_get());
+    zassert_ok(flash_read(flash_dev, CHUNK_TEST_BASE, bulk, sizeof(bulk)));
+    mx_flash_read_background_set(flash_dev, false);
+    zassert_is_null(data->background_thread);
+
+    zassert_mem_equal(bulk, pattern, sizeof(pattern));
+    zassert_ok(mx_flash_lock_stats_get(flash_dev, &lock));
+    zassert_equal(lock.read_chunks,
+                  DIV_ROUND_UP(sizeof(bulk), CONFIG_MX25_FLASH_READ_CHUNK_SIZE));
+    zassert_equal(lock.read_yields, 0);
+
+    /* Erase holds are reported apart from read holds */
+    zassert_equal(lock.max_erase_hold_us, 0);
+    zassert_ok(flash_erase(flash_dev, CHUNK_TEST_BASE, MX25_SECTOR_SIZE));
+    zassert_ok(mx_flash_lock_stats_get(flash_dev, &lock));
+    zassert_true(lock.max_erase_hold_us >= MX25_EMUL_SECTOR_ERASE_US);
+    zassert_true(lock.max_read_hold_us < lock.max_erase_hold_us);
+}
+
+#define READER_STACK_SIZE 2048
+
+static K_THREAD_STACK_DEFINE(bulk_stack, READER_STACK_SIZE);
+static K_THREAD_STACK_DEFINE(small_stack, READER_STACK_SIZE);
+static struct k_thread bulk_thread;
+static struct k_thread small_thread;
+static uint8_t small[16];
+static atomic_t readers_done;
+static int bulk_ret;
+static int small_ret;
+static atomic_val_t bulk_order;
+static atomic_val_t small_order;
+
+static void bulk_reader(void *p1, void *p2, void *p3)
+{
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    mx_flash_read_background_set(flash_dev, true);
+    bulk_ret = flash_read(flash_dev, CHUNK_TEST_BASE, bulk, sizeof(bulk));
+    mx_flash_read_background_set(flash_dev, false);
+    bulk_order = atomic_inc(&readers_done);
+}
+
+static void small_reader(void *p1, void *p2, void *p3)
+{
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    small_ret = flash_read(flash_dev, CHUNK_TEST_BASE + 0x10, small, sizeof(small));
+    small_order = atomic_inc(&readers_done);
+}
+
+ZTEST(mx_flash, test_read_priority)
+{
+    struct mx_flash_lock_stats lock;
+
+    pattern_program();
+    mx_flash_lock_stats_reset(flash_dev);
+    atomic_clear(&readers_done);
+
+    /*
+     * Both readers start while the erase below holds the lock and queue
+     * on it, the background reader ahead of the lower priority
+     * interactive one. After its first chunk the background reader
+     * must step aside until the small read is done.
+     */
+    k_thread_create(&bulk_thread, bulk_stack, K_THREAD_STACK_SIZEOF(bulk_stack),
+                    bulk_reader, NULL, NULL, NULL, K_PRIO_PREEMPT(1), 0, K_MSEC(1));
+    k_thread_create(&small_thread, small_stack, K_THREAD_STACK_SIZEOF(small_stack),
+                    small_reader, NULL, NULL, NULL, K_PRIO_PREEMPT(2), 0, K_MSEC(1));
+    zassert_ok(flash_erase(flash_dev, CHUNK_TEST_BASE + 0x8000, MX25_SECTOR_SIZE));
+
+    zassert_ok(k_thread_join(&bulk_thread, K_SECONDS(1)));
+    zassert_ok(k_thread_join(&small_thread, K_SECONDS(1)));
+
+    zassert_ok(bulk_ret);
+    zassert_ok(small_ret);
+    zassert_mem_equal(bulk, pattern, sizeof(pattern));
+    zassert_mem_equal(small, &pattern[0x10], sizeof(small));
+
+    zassert_ok(mx_flash_lock_stats_get(flash_dev, &lock));
+    zassert_equal(lock.read_yields, 1);
+    zassert_true(small_order < bulk_order, "Interactive read waited for the bulk read");
+}
+
+static void *mx_flash_setup(void)
+{
+    zassert_true(device_is_ready(flash_dev), "MX25 flash not ready");
+    return NULL;
+}
+
+static void mx_flash_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    mx_flash_emul_stats_reset(flash_emul);
+    mx_flash_cache_stats_reset(flash_dev);
+}
+
+ZTEST_SUITE(mx_flash, NULL, mx_flash_setup, mx_flash_before, NULL, NULL);